@@ -0,0 +1,466 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <numeric>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "parallel.h"
+
+using namespace std;
+
+/**
+ * @struct Workload
+ * @brief One algorithm, the graph family it runs on and the vertex counts to measure.
+ */
+struct Workload
+{
+    string name;                      // Name of the benchmark in the report
+    string tool;                      // Executable of the exercise
+    vector<string> toolArguments;     // Arguments after the input file
+    string family;                    // Generator family
+    vector<long long> sizes;          // Vertex counts before scaling
+    long long averageDegree;          // Average degree, m = n * averageDegree / 2 for undirected families
+    vector<string> generatorArguments; // Extra generator options such as trailing data
+    string phase = "";                // Instrumentation phase to time instead of the whole run, empty for wall time
+};
+
+/**
+ * @struct Options
+ * @brief Command line options of the benchmark.
+ */
+struct Options
+{
+    string binaryDirectory = ".";        // Directory with the compiled exercises and graph_generator
+    string workDirectory = "benchmark_inputs"; // Directory for the generated inputs, reused between runs
+    string output;                       // JSON report, empty for standard output
+    string filter;                       // Only run benchmarks whose name contains this
+    int warmup = 1;                      // Untimed runs before measuring
+    int repetitions = 5;                 // Timed runs
+    double scale = 1.0;                  // Factor applied to all vertex counts
+    double budget = 60.0;                // Larger sizes are skipped once a run takes longer than this many seconds
+};
+
+/**
+ * @struct Measurement
+ * @brief Result of running one workload at one size.
+ */
+struct Measurement
+{
+    string name;            // Name of the benchmark
+    string family;          // Generator family
+    string input;           // Input file
+    string phase;           // Timed instrumentation phase, empty for the whole run
+    long long vertices = 0; // Number of vertices from the input header
+    long long edges = 0;    // Number of edges from the input header
+    vector<double> seconds; // Wall time of every timed run
+    long maxResidentKiB = 0; // Peak resident memory over all runs
+    int exitCode = 0;       // Exit code of the last failing run, 0 if all succeeded
+};
+
+/**
+ * @brief The workloads, vertex counts are chosen so every exercise finishes in seconds at scale 1.
+ */
+vector<Workload> defaultWorkloads()
+{
+    return {
+        {"ex1_1 degree statistics", "ex1_1", {}, "er", {100000, 1000000}, 16, {}},
+        {"ex1_1 degree statistics", "ex1_1", {}, "rmat", {100000, 1000000}, 16, {}},
+        {"ex1_2 cut evaluation", "ex1_2", {}, "er", {100000, 1000000}, 16, {"--partition", "8"}},
+        {"ex2_1 max cut", "ex2_1", {"--max-cut"}, "er", {100000, 1000000}, 8, {}},
+        {"ex2_1 multi-start max cut", "ex2_1", {"--multi-start", "--starts", "16", "--seed", "1"}, "er", {100000, 1000000}, 8, {}},
+        {"ex2_1 triangles", "ex2_1", {"--triangles"}, "rmat", {100000, 1000000}, 16, {}},
+        {"ex3 max cut", "ex3", {}, "er", {10000, 100000}, 8, {}},
+        {"ex3 multilevel max cut", "ex3", {"--multilevel", "--seed", "1"}, "er", {100000, 1000000}, 8, {}},
+        {"ex3 spectral max cut", "ex3", {"--spectral", "--seed", "1"}, "er", {100000, 1000000}, 8, {}},
+        {"ex3 spmv kernel", "ex3", {"--spmv", "--iterations", "200", "--seed", "1"}, "rmat", {100000, 1000000}, 16, {}, "algorithm/lanczos"},
+        {"ex4 mwis", "ex4", {}, "er", {10000, 100000}, 8, {"--vertex-weights", "1:100"}},
+        {"ex4 reduce star", "ex4", {"--reduce"}, "star", {20000, 80000}, 2, {"--vertex-weights", "1:1"}},
+        {"ex4 parallel mwis", "ex4", {"--parallel", "--seed", "1"}, "rmat", {100000, 1000000}, 8, {"--vertex-weights", "1:100"}},
+        {"ex4 exact mwis", "ex4", {"--exact", "--reduce", "--node-limit", "200000"}, "er", {200, 2000}, 8, {"--vertex-weights", "1:100"}},
+        {"ex5 dinic", "ex5", {}, "rgg", {1000, 10000}, 8, {"--source-target", "--weights", "1:10"}},
+        {"ex5 dinic directed", "ex5", {"--directed"}, "dag", {10000, 100000}, 8, {"--source-target", "--weights", "1:10"}},
+        {"ex6 bellman-ford", "ex6", {}, "negcycle", {1000, 4000}, 8, {}},
+        {"ex6_faster bellman-ford", "ex6_faster", {}, "negcycle", {1000, 4000}, 8, {}},
+        {"ex7 matching", "ex7", {}, "er", {1000, 10000}, 8, {}},
+        {"ex8 topological sort", "ex8", {}, "dag", {100000, 1000000}, 8, {}},
+        {"ex9 edge coloring", "ex9", {}, "er", {1000, 10000}, 8, {}},
+        {"ex9_faster edge coloring", "ex9_faster", {}, "er", {1000, 10000}, 8, {}},
+        {"ex10 diameter", "ex10", {}, "grid2d", {1024, 4096}, 4, {}},
+    };
+}
+
+/**
+ * @brief Prints how to call the benchmark.
+ */
+void printUsage()
+{
+    cerr << "usage: benchmark [options]" << endl
+         << "  --bin DIR          directory with the exercise binaries and graph_generator (default .)" << endl
+         << "  --work DIR         directory for generated inputs (default benchmark_inputs)" << endl
+         << "  --warmup W         untimed runs per measurement (default 1)" << endl
+         << "  --repetitions R    timed runs per measurement (default 5)" << endl
+         << "  --scale F          multiply all vertex counts by F (default 1)" << endl
+         << "  --budget SECONDS   skip larger sizes once a run exceeds this time (default 60)" << endl
+         << "  --filter TEXT      only run benchmarks whose name contains TEXT" << endl
+         << "Kernel benchmarks such as \"ex3 spmv kernel\" time one instrumentation phase instead of the" << endl
+         << "whole run, their tool has to be built with -DAE_INSTRUMENT." << endl
+         << "  -o FILE            write the JSON report to FILE (default standard output)" << endl;
+}
+
+/**
+ * @brief Parses the command line into options.
+ * @return False on invalid arguments.
+ */
+bool parseOptions(int argc, char *argv[], Options &options)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        string option = argv[i];
+        if (i + 1 >= argc)
+            return false;
+        string value = argv[++i];
+
+        if (option == "--bin")
+            options.binaryDirectory = value;
+        else if (option == "--work")
+            options.workDirectory = value;
+        else if (option == "--warmup")
+            options.warmup = max(0, atoi(value.c_str()));
+        else if (option == "--repetitions")
+            options.repetitions = max(1, atoi(value.c_str()));
+        else if (option == "--scale")
+            options.scale = atof(value.c_str());
+        else if (option == "--budget")
+            options.budget = atof(value.c_str());
+        else if (option == "--filter")
+            options.filter = value;
+        else if (option == "-o")
+            options.output = value;
+        else
+            return false;
+    }
+
+    return options.scale > 0;
+}
+
+/**
+ * @brief Runs a program with its output discarded and waits for it.
+ * @param arguments The program followed by its arguments.
+ * @param seconds Wall time of the run.
+ * @param maxResidentKiB Peak resident memory of the run.
+ * @param reportPath The file the instrumentation report is written to, empty to leave AE_REPORT unset.
+ * @return The exit code, or -1 if the program could not be started or crashed.
+ */
+int runProgram(const vector<string> &arguments, double &seconds, long &maxResidentKiB, const string &reportPath = "")
+{
+    vector<char *> argv;
+    for (const string &argument : arguments)
+        argv.push_back(const_cast<char *>(argument.c_str()));
+    argv.push_back(nullptr);
+
+    auto start = chrono::steady_clock::now();
+    pid_t child = fork();
+    if (child < 0)
+        return -1;
+
+    if (child == 0)
+    {
+        int devNull = open("/dev/null", O_WRONLY);
+        dup2(devNull, STDOUT_FILENO);
+        dup2(devNull, STDERR_FILENO);
+        if (!reportPath.empty())
+            setenv("AE_REPORT", reportPath.c_str(), 1);
+        execv(argv[0], argv.data());
+        _exit(127);
+    }
+
+    int status = 0;
+    struct rusage usage;
+    if (wait4(child, &status, 0, &usage) < 0)
+        return -1;
+    seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    maxResidentKiB = usage.ru_maxrss;
+
+    return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+}
+
+/**
+ * @brief Builds the generator arguments of a workload at one size.
+ */
+vector<string> generatorArguments(const Workload &workload, long long vertices)
+{
+    vector<string> arguments = {workload.family};
+    if (workload.family == "grid2d")
+    {
+        long long side = max(1LL, static_cast<long long>(sqrt(static_cast<double>(vertices))));
+        arguments.insert(arguments.end(), {"--rows", to_string(side), "--cols", to_string(side)});
+    }
+    else if (workload.family == "rgg")
+    {
+        double radius = sqrt(workload.averageDegree / (M_PI * vertices));
+        arguments.insert(arguments.end(), {"-n", to_string(vertices), "--radius", to_string(radius)});
+    }
+    else
+    {
+        // Directed families write one line per arc, undirected ones both directions of an edge
+        bool directed = workload.family == "dag" || workload.family == "negcycle";
+        long long edges = directed ? vertices * workload.averageDegree : vertices * workload.averageDegree / 2;
+        arguments.insert(arguments.end(), {"-n", to_string(vertices), "-m", to_string(edges)});
+    }
+    arguments.insert(arguments.end(), workload.generatorArguments.begin(), workload.generatorArguments.end());
+    arguments.insert(arguments.end(), {"--seed", "42"});
+    return arguments;
+}
+
+/**
+ * @brief Generates an input unless a file for the same generator arguments already exists.
+ * @return The path of the input, empty on failure.
+ */
+string prepareInput(const Options &options, const vector<string> &arguments)
+{
+    string name;
+    for (const string &argument : arguments)
+        for (char character : argument)
+            name += isalnum(static_cast<unsigned char>(character)) || character == '.' ? character : '_';
+    string path = options.workDirectory + "/" + name + ".txt";
+
+    struct stat status;
+    if (stat(path.c_str(), &status) == 0 && status.st_size > 0)
+        return path;
+
+    vector<string> command = {options.binaryDirectory + "/graph_generator"};
+    command.insert(command.end(), arguments.begin(), arguments.end());
+    command.insert(command.end(), {"-o", path});
+
+    double seconds;
+    long maxResidentKiB;
+    if (runProgram(command, seconds, maxResidentKiB) != 0)
+    {
+        remove(path.c_str());
+        return "";
+    }
+    return path;
+}
+
+/**
+ * @brief Escapes a string for JSON.
+ */
+string jsonString(const string &text)
+{
+    string escaped = "\"";
+    for (char character : text)
+    {
+        if (character == '"' || character == '\\')
+            escaped += '\\';
+        escaped += character;
+    }
+    return escaped + "\"";
+}
+
+/**
+ * @brief Reads the time of one phase from an instrumentation report.
+ * @param reportPath The report written by a tool built with -DAE_INSTRUMENT.
+ * @param phase The full path of the phase, such as "algorithm/lanczos".
+ * @param seconds Receives the accumulated time of the phase.
+ * @return False if the report or the phase is missing.
+ */
+bool readPhaseSeconds(const string &reportPath, const string &phase, double &seconds)
+{
+    ifstream report(reportPath);
+    string text((istreambuf_iterator<char>(report)), istreambuf_iterator<char>());
+    string key = "{\"name\": " + jsonString(phase) + ", \"seconds\": ";
+    size_t position = text.find(key);
+    if (position == string::npos)
+        return false;
+
+    seconds = atof(text.c_str() + position + key.size());
+    return true;
+}
+
+/**
+ * @brief Returns the current git commit, or an empty string outside of a repository.
+ */
+string currentCommit()
+{
+    string commit;
+    FILE *pipe = popen("git rev-parse --short HEAD 2>/dev/null", "r");
+    if (!pipe)
+        return commit;
+    char buffer[64];
+    if (fgets(buffer, sizeof(buffer), pipe))
+        commit = buffer;
+    pclose(pipe);
+    commit.erase(remove(commit.begin(), commit.end(), '\n'), commit.end());
+    return commit;
+}
+
+/**
+ * @brief Writes the measurements as JSON with summary statistics per measurement.
+ */
+void writeReport(ostream &out, const Options &options, const vector<Measurement> &measurements)
+{
+    out << "{\n"
+        << "  \"commit\": " << jsonString(currentCommit()) << ",\n"
+        << "  \"threads\": " << numberOfThreads() << ",\n"
+        << "  \"warmup\": " << options.warmup << ",\n"
+        << "  \"repetitions\": " << options.repetitions << ",\n"
+        << "  \"scale\": " << options.scale << ",\n"
+        << "  \"results\": [";
+
+    for (size_t i = 0; i < measurements.size(); ++i)
+    {
+        const Measurement &measurement = measurements[i];
+        vector<double> sorted = measurement.seconds;
+        sort(sorted.begin(), sorted.end());
+        double mean = 0, deviation = 0, median = 0;
+        if (!sorted.empty())
+        {
+            mean = accumulate(sorted.begin(), sorted.end(), 0.0) / sorted.size();
+            for (double seconds : sorted)
+                deviation += (seconds - mean) * (seconds - mean);
+            deviation = sqrt(deviation / sorted.size());
+            median = sorted.size() % 2 ? sorted[sorted.size() / 2] : (sorted[sorted.size() / 2 - 1] + sorted[sorted.size() / 2]) / 2;
+        }
+
+        out << (i ? "," : "") << "\n    {"
+            << "\"benchmark\": " << jsonString(measurement.name)
+            << ", \"family\": " << jsonString(measurement.family)
+            << ", \"input\": " << jsonString(measurement.input)
+            << ", \"phase\": " << jsonString(measurement.phase)
+            << ", \"vertices\": " << measurement.vertices
+            << ", \"edges\": " << measurement.edges
+            << ", \"exitCode\": " << measurement.exitCode
+            << ", \"seconds\": [";
+        for (size_t run = 0; run < measurement.seconds.size(); ++run)
+            out << (run ? ", " : "") << measurement.seconds[run];
+        out << "]"
+            << ", \"min\": " << (sorted.empty() ? 0 : sorted.front())
+            << ", \"median\": " << median
+            << ", \"mean\": " << mean
+            << ", \"stddev\": " << deviation
+            << ", \"maxResidentKiB\": " << measurement.maxResidentKiB << "}";
+    }
+
+    out << "\n  ]\n}" << endl;
+}
+
+/**
+ * @brief Main function
+ *
+ * This function generates the inputs of every workload, runs each exercise on them with warmup
+ * and repetitions and writes the timings as JSON, so results can be compared across commits.
+ *
+ * @return 0 if every run succeeded, 1 otherwise
+ */
+int main(int argc, char *argv[])
+{
+    Options options;
+    if (!parseOptions(argc, argv, options))
+    {
+        printUsage();
+        return 1;
+    }
+
+    mkdir(options.workDirectory.c_str(), 0755);
+
+    vector<Measurement> measurements;
+    bool failed = false;
+    for (const Workload &workload : defaultWorkloads())
+    {
+        if (!options.filter.empty() && workload.name.find(options.filter) == string::npos)
+            continue;
+
+        for (long long size : workload.sizes)
+        {
+            long long vertices = max(2LL, static_cast<long long>(size * options.scale));
+            vector<string> arguments = generatorArguments(workload, vertices);
+
+            Measurement measurement;
+            measurement.name = workload.name;
+            measurement.family = workload.family;
+            measurement.phase = workload.phase;
+            measurement.input = prepareInput(options, arguments);
+            if (measurement.input.empty())
+            {
+                cerr << "Failed to generate the input of " << workload.name << "." << endl;
+                failed = true;
+                break;
+            }
+
+            ifstream header(measurement.input);
+            header >> measurement.vertices >> measurement.edges;
+
+            vector<string> command = {options.binaryDirectory + "/" + workload.tool, measurement.input};
+            command.insert(command.end(), workload.toolArguments.begin(), workload.toolArguments.end());
+            string reportPath = workload.phase.empty() ? "" : options.workDirectory + "/report.json";
+
+            cerr << workload.name << " (" << workload.family << ", n = " << measurement.vertices
+                 << ", m = " << measurement.edges << ")" << flush;
+            for (int run = 0; run < options.warmup + options.repetitions; ++run)
+            {
+                double seconds = 0;
+                long maxResidentKiB = 0;
+                if (!reportPath.empty())
+                    remove(reportPath.c_str());
+                int exitCode = runProgram(command, seconds, maxResidentKiB, reportPath);
+                if (exitCode != 0)
+                {
+                    measurement.exitCode = exitCode;
+                    failed = true;
+                }
+
+                // Kernel benchmarks time only their phase, which needs an instrumented build
+                if (!reportPath.empty() && exitCode == 0 && !readPhaseSeconds(reportPath, workload.phase, seconds))
+                {
+                    cerr << ": no phase " << workload.phase << " in the report, build " << workload.tool << " with -DAE_INSTRUMENT" << endl;
+                    measurement.exitCode = -1;
+                    failed = true;
+                    break;
+                }
+                measurement.maxResidentKiB = max(measurement.maxResidentKiB, maxResidentKiB);
+                if (run >= options.warmup)
+                    measurement.seconds.push_back(seconds);
+
+                // A single timed run over the budget means the larger sizes will not finish in time
+                if (run >= options.warmup && seconds > options.budget)
+                    break;
+            }
+            if (measurement.seconds.empty())
+            {
+                measurements.push_back(measurement);
+                break;
+            }
+            cerr << ": " << *min_element(measurement.seconds.begin(), measurement.seconds.end()) << " s" << endl;
+            measurements.push_back(measurement);
+
+            if (measurement.seconds.back() > options.budget)
+                break;
+        }
+    }
+
+    if (options.output.empty())
+        writeReport(cout, options, measurements);
+    else
+    {
+        ofstream out(options.output);
+        if (!out)
+        {
+            cerr << "Failed to open the file." << endl;
+            return 1;
+        }
+        writeReport(out, options, measurements);
+    }
+
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,175 @@
+#ifndef BUCKET_QUEUE_H
+#define BUCKET_QUEUE_H
+
+#include <cstdint>
+#include <queue>
+#include <utility>
+#include <vector>
+
+/**
+ * @class BucketQueue
+ * @brief Addressable max priority queue over the elements 0..n-1 with integer keys.
+ *
+ * Keys in a small range [minKey, maxKey] are kept in one doubly linked bucket per key, which makes
+ * push, remove and key changes O(1) and finding the maximum amortized O(1) for keys that change by
+ * small steps, as gains in local search do. If the key range is larger than maxBuckets the queue
+ * falls back to a binary heap with lazy deletion, O(log n) per operation.
+ */
+class BucketQueue
+{
+private:
+    int64_t _minKey;               // Smallest key, stored in bucket 0
+    bool _useBuckets;              // Buckets or heap
+    std::vector<int64_t> _keys;    // Current key of every element
+    std::vector<char> _contained;  // Whether an element is in the queue
+    int64_t _size = 0;             // Number of elements in the queue
+
+    std::vector<int> _head;        // First element of every bucket, -1 if empty
+    std::vector<int> _next;        // Next element in the same bucket
+    std::vector<int> _previous;    // Previous element in the same bucket, -1 for the first one
+    int64_t _topBucket = -1;       // No bucket above this one is occupied
+
+    std::priority_queue<std::pair<int64_t, int> > _heap; // Heap entries, stale if the key changed
+
+    void _link(int element)
+    {
+        int64_t bucket = _keys[element] - _minKey;
+        _previous[element] = -1;
+        _next[element] = _head[bucket];
+        if (_head[bucket] != -1)
+            _previous[_head[bucket]] = element;
+        _head[bucket] = element;
+        if (bucket > _topBucket)
+            _topBucket = bucket;
+    }
+
+    void _unlink(int element)
+    {
+        int64_t bucket = _keys[element] - _minKey;
+        if (_previous[element] != -1)
+            _next[_previous[element]] = _next[element];
+        else
+            _head[bucket] = _next[element];
+        if (_next[element] != -1)
+            _previous[_next[element]] = _previous[element];
+    }
+
+public:
+    /**
+     * @brief Creates an empty queue
+     * @param elements The number of elements.
+     * @param minKey The smallest key that will be used.
+     * @param maxKey The largest key that will be used.
+     * @param maxBuckets The largest key range that is stored in buckets.
+     */
+    BucketQueue(int elements, int64_t minKey, int64_t maxKey, int64_t maxBuckets = 1 << 24)
+        : _minKey(minKey), _useBuckets(maxKey - minKey < maxBuckets), _keys(elements, 0), _contained(elements, 0)
+    {
+        if (_useBuckets)
+        {
+            _head.assign(maxKey - minKey + 1, -1);
+            _next.assign(elements, -1);
+            _previous.assign(elements, -1);
+        }
+    }
+
+    /**
+     * @brief Removes all elements in O(n) without touching the buckets that are empty
+     */
+    void clear()
+    {
+        for (int element = 0; element < static_cast<int>(_contained.size()); ++element)
+            if (_contained[element])
+            {
+                _contained[element] = 0;
+                if (_useBuckets)
+                    _head[_keys[element] - _minKey] = -1;
+            }
+        _size = 0;
+        _topBucket = -1;
+        _heap = std::priority_queue<std::pair<int64_t, int> >();
+    }
+
+    bool empty() const { return _size == 0; }
+    int64_t size() const { return _size; }
+    bool contains(int element) const { return _contained[element]; }
+    int64_t key(int element) const { return _keys[element]; }
+
+    /**
+     * @brief Inserts an element that is not in the queue
+     */
+    void push(int element, int64_t key)
+    {
+        _keys[element] = key;
+        _contained[element] = 1;
+        ++_size;
+        if (_useBuckets)
+            _link(element);
+        else
+            _heap.emplace(key, element);
+    }
+
+    /**
+     * @brief Removes an element that is in the queue
+     */
+    void remove(int element)
+    {
+        _contained[element] = 0;
+        --_size;
+        if (_useBuckets)
+            _unlink(element);
+    }
+
+    /**
+     * @brief Changes the key of an element that is in the queue
+     */
+    void update(int element, int64_t key)
+    {
+        if (key == _keys[element])
+            return;
+
+        if (_useBuckets)
+        {
+            _unlink(element);
+            _keys[element] = key;
+            _link(element);
+        }
+        else
+        {
+            _keys[element] = key;
+            _heap.emplace(key, element);
+        }
+    }
+
+    /**
+     * @brief Returns an element with the largest key, the queue must not be empty
+     */
+    int top()
+    {
+        if (_useBuckets)
+        {
+            while (_head[_topBucket] == -1)
+                --_topBucket;
+            return _head[_topBucket];
+        }
+
+        // Drop heap entries of removed elements and of outdated keys
+        while (!_contained[_heap.top().second] || _keys[_heap.top().second] != _heap.top().first)
+            _heap.pop();
+        return _heap.top().second;
+    }
+
+    /**
+     * @brief Removes and returns an element with the largest key, the queue must not be empty
+     */
+    int pop()
+    {
+        int element = top();
+        if (!_useBuckets)
+            _heap.pop();
+        remove(element);
+        return element;
+    }
+};
+
+#endif
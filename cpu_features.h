@@ -0,0 +1,28 @@
+#ifndef CPU_FEATURES_H
+#define CPU_FEATURES_H
+
+/**
+ * Detection of the x86 SIMD extensions used by the vectorized kernels. AE_X86_SIMD is defined when
+ * the compiler can generate SSE2 and AVX2 code through target attributes; whether the processor
+ * actually supports AVX2 is checked once at run time with hasAVX2().
+ */
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define AE_X86_SIMD 1
+#include <immintrin.h>
+#endif
+
+#ifdef AE_X86_SIMD
+
+/**
+ * @brief Returns whether the processor supports AVX2, checked once
+ */
+inline bool hasAVX2()
+{
+    static const bool supported = __builtin_cpu_supports("avx2");
+    return supported;
+}
+
+#endif
+
+#endif
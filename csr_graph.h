@@ -0,0 +1,193 @@
+#ifndef CSR_GRAPH_H
+#define CSR_GRAPH_H
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+/**
+ * @struct InputEdge
+ * @brief Structure to represent one "source destination weight" line of the input.
+ * @param source The source vertex of the edge (0-indexed).
+ * @param destination The destination vertex of the edge (0-indexed).
+ * @param weight The weight of the edge.
+ */
+struct InputEdge
+{
+    int source;      // Source vertex of the edge
+    int destination; // Destination vertex of the edge
+    int weight;      // Weight of the edge
+};
+
+/**
+ * @struct NeighborRange
+ * @brief Contiguous range of neighbor IDs, usable in range-based for loops.
+ */
+struct NeighborRange
+{
+    const int *first; // First neighbor of the range
+    const int *last;  // One past the last neighbor of the range
+
+    const int *begin() const { return first; }
+    const int *end() const { return last; }
+    int64_t size() const { return last - first; }
+};
+
+/**
+ * @class CSRGraph
+ * @brief Compressed sparse row graph shared by all exercises.
+ *
+ * The arcs of vertex v occupy the index range [firstArc(v), lastArc(v)) of one contiguous
+ * target array and one contiguous weight array. Compared to a vector<vector<Edge> > this
+ * needs two allocations instead of one per vertex and turns every traversal into a linear scan.
+ * Arc indices are 64-bit so the graph can hold more than 2^31 arcs.
+ *
+ * The arrays are either owned by the graph or borrowed from an external buffer such as a memory
+ * mapped snapshot, in which case the graph keeps that buffer alive. Graphs can be moved but not copied.
+ */
+class CSRGraph
+{
+private:
+    int _numberOfVertices = 0;           // Number of vertices in the graph
+    std::vector<int64_t> _offsetStorage; // Owned offsets, empty for borrowed arrays
+    std::vector<int> _targetStorage;     // Owned targets, empty for borrowed arrays
+    std::vector<int> _weightStorage;     // Owned weights, empty for borrowed arrays
+    std::shared_ptr<const void> _owner;  // Keeps borrowed arrays alive
+    const int64_t *_offsets = nullptr;   // Index of the first arc of every vertex, plus one sentinel
+    const int *_targets = nullptr;       // Destination vertex of every arc
+    const int *_weights = nullptr;       // Weight of every arc
+
+public:
+    CSRGraph() : _offsetStorage(1, 0), _offsets(_offsetStorage.data()) {}
+
+    CSRGraph(CSRGraph &&) = default;
+    CSRGraph &operator=(CSRGraph &&) = default;
+    CSRGraph(const CSRGraph &) = delete;
+    CSRGraph &operator=(const CSRGraph &) = delete;
+
+    /**
+     * @brief Builds the graph from a list of edges.
+     *
+     * The edges are distributed to their source vertex with a counting sort, so the arcs of each
+     * vertex keep the order in which they appear in the input.
+     *
+     * @param vertices The number of vertices in the graph.
+     * @param edges The edges of the graph, 0-indexed. Each direction of an undirected edge is one entry.
+     */
+    CSRGraph(int vertices, const std::vector<InputEdge> &edges)
+        : _numberOfVertices(vertices), _offsetStorage(vertices + 1, 0), _targetStorage(edges.size()), _weightStorage(edges.size())
+    {
+        // Count the out-degree of every vertex
+        for (const InputEdge &edge : edges)
+            _offsetStorage[edge.source + 1]++;
+
+        // Prefix sum turns the degrees into the first arc of every vertex
+        for (int vertex = 0; vertex < _numberOfVertices; ++vertex)
+            _offsetStorage[vertex + 1] += _offsetStorage[vertex];
+
+        // Scatter the edges into their slots
+        std::vector<int64_t> position(_offsetStorage.begin(), _offsetStorage.end() - 1);
+        for (const InputEdge &edge : edges)
+        {
+            int64_t arc = position[edge.source]++;
+            _targetStorage[arc] = edge.destination;
+            _weightStorage[arc] = edge.weight;
+        }
+
+        _offsets = _offsetStorage.data();
+        _targets = _targetStorage.data();
+        _weights = _weightStorage.data();
+    }
+
+    /**
+     * @brief Wraps existing CSR arrays without copying them.
+     * @param vertices The number of vertices in the graph.
+     * @param offsets The vertices + 1 arc offsets.
+     * @param targets The destination vertex of every arc.
+     * @param weights The weight of every arc.
+     * @param owner Keeps the memory behind the arrays alive as long as the graph exists.
+     */
+    CSRGraph(int vertices, const int64_t *offsets, const int *targets, const int *weights, std::shared_ptr<const void> owner)
+        : _numberOfVertices(vertices), _owner(std::move(owner)), _offsets(offsets), _targets(targets), _weights(weights)
+    {
+    }
+
+    /**
+     * @brief Returns the number of vertices of the graph
+     * @return The number of vertices
+     */
+    int numberOfVertices() const { return _numberOfVertices; }
+
+    /**
+     * @brief Returns the number of arcs of the graph (both directions of an undirected edge count)
+     * @return The number of arcs
+     */
+    int64_t numberOfArcs() const { return _offsets[_numberOfVertices]; }
+
+    /**
+     * @brief Returns the index of the first arc of a vertex
+     * @param vertex The vertex
+     * @return The index of the first arc
+     */
+    int64_t firstArc(int vertex) const { return _offsets[vertex]; }
+
+    /**
+     * @brief Returns the index one past the last arc of a vertex
+     * @param vertex The vertex
+     * @return The index one past the last arc
+     */
+    int64_t lastArc(int vertex) const { return _offsets[vertex + 1]; }
+
+    /**
+     * @brief Returns the number of arcs leaving a vertex
+     * @param vertex The vertex
+     * @return The degree of the vertex
+     */
+    int degree(int vertex) const { return static_cast<int>(_offsets[vertex + 1] - _offsets[vertex]); }
+
+    /**
+     * @brief Returns the destination vertex of an arc
+     * @param arc The arc index
+     * @return The destination vertex
+     */
+    int target(int64_t arc) const { return _targets[arc]; }
+
+    /**
+     * @brief Returns the weight of an arc
+     * @param arc The arc index
+     * @return The weight of the arc
+     */
+    int weight(int64_t arc) const { return _weights[arc]; }
+
+    /**
+     * @brief Returns the neighbors of a vertex as a contiguous range
+     * @param vertex The vertex
+     * @return The range of neighbor IDs
+     */
+    NeighborRange neighbors(int vertex) const
+    {
+        return NeighborRange{_targets + _offsets[vertex], _targets + _offsets[vertex + 1]};
+    }
+
+    /**
+     * @brief Finds the first arc from source to destination by scanning the arcs of source
+     * @param source The source vertex
+     * @param destination The destination vertex
+     * @return The arc index, or -1 if there is no such arc
+     */
+    int64_t findArc(int source, int destination) const
+    {
+        for (int64_t arc = _offsets[source]; arc < _offsets[source + 1]; ++arc)
+            if (_targets[arc] == destination)
+                return arc;
+
+        return -1;
+    }
+
+    // Raw arrays for kernels that want to stream over the whole graph
+    const int64_t *offsets() const { return _offsets; }
+    const int *targets() const { return _targets; }
+    const int *weights() const { return _weights; }
+};
+
+#endif
@@ -0,0 +1,52 @@
+#ifndef DEGREE_STATISTICS_H
+#define DEGREE_STATISTICS_H
+
+#include <algorithm>
+#include <climits>
+
+/**
+ * @struct DegreeStatistics
+ * @brief Extremes of the degrees and weighted degrees and the total weight of a set of vertices.
+ *
+ * Every thread fills its own instance for a block of vertices, then the instances are merged. They are
+ * padded to a cache line so the instances of different threads do not share one.
+ */
+struct alignas(64) DegreeStatistics
+{
+    long long minDegree = LLONG_MAX;
+    long long maxDegree = LLONG_MIN;
+    long long minWeightedDegree = LLONG_MAX;
+    long long maxWeightedDegree = LLONG_MIN;
+    long long maxAbsoluteWeightedDegree = 0; // Largest sum of absolute arc weights, only kept by ex2_1
+    long long totalWeight = 0;               // Sum of the weighted degrees, twice the total edge weight
+
+    /**
+     * @brief Adds a vertex
+     * @param degree The degree of the vertex
+     * @param weightedDegree The total weight of its arcs
+     */
+    void add(long long degree, long long weightedDegree)
+    {
+        minDegree = std::min(minDegree, degree);
+        maxDegree = std::max(maxDegree, degree);
+        minWeightedDegree = std::min(minWeightedDegree, weightedDegree);
+        maxWeightedDegree = std::max(maxWeightedDegree, weightedDegree);
+        totalWeight += weightedDegree;
+    }
+
+    /**
+     * @brief Merges the statistics of another set of vertices
+     * @param other The other statistics
+     */
+    void merge(const DegreeStatistics &other)
+    {
+        minDegree = std::min(minDegree, other.minDegree);
+        maxDegree = std::max(maxDegree, other.maxDegree);
+        minWeightedDegree = std::min(minWeightedDegree, other.minWeightedDegree);
+        maxWeightedDegree = std::max(maxWeightedDegree, other.maxWeightedDegree);
+        maxAbsoluteWeightedDegree = std::max(maxAbsoluteWeightedDegree, other.maxAbsoluteWeightedDegree);
+        totalWeight += other.totalWeight;
+    }
+};
+
+#endif
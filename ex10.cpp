@@ -1,7 +1,10 @@
 #include <vector>
 #include <iostream>
 #include <queue>
-#include <fstream>
+
+#include "csr_graph.h"
+#include "graph_reader.h"
+#include "instrumentation.h"
 
 using namespace std;
 
@@ -9,7 +12,7 @@ class Graph
 {
 private:
     int _numberOfVertices; // Number of vertices in the graph
-    vector<vector<int> > _adjacencyList; // Adjacency list to represent the graph
+    CSRGraph _graph;       // CSR structure of the graph
 
     pair <int, int> _BFS(int startNode)
     {
@@ -25,9 +28,8 @@ private:
             int currentNode = q.front();
             q.pop();
 
-            for (const int &edge : _adjacencyList[currentNode])
+            for (int neighbor : _graph.neighbors(currentNode))
             {
-                int neighbor = edge;
                 if (distances[neighbor] == -1)
                 {
                     distances[neighbor] = distances[currentNode] + 1;
@@ -45,68 +47,65 @@ private:
     }
 
 public:
-    Graph(int vertices, int edges) : _numberOfVertices(vertices)
-    {
-        _adjacencyList.resize(_numberOfVertices);
-    }
-
-    void addEdge(int source, int destination)
+    Graph(CSRGraph graph) : _numberOfVertices(graph.numberOfVertices()), _graph(move(graph))
     {
-        _adjacencyList[source - 1].push_back(destination - 1);
     }
 
     void findDiameter()
     {
-        // Start BFS from an arbitrary node (0)
-        pair <int, int> currentResult = _BFS(0);
-        int maxDistance = currentResult.first;
-        int node1 = 0;
-        int node2 = currentResult.second;
-
-        for (int i = 1; i < _numberOfVertices; ++i)
+        int maxDistance, node1, node2;
         {
-            pair <int, int> newCurrentResult = _BFS(i);
+            AE_PHASE("algorithm");
+
+            // Start BFS from an arbitrary node (0)
+            pair <int, int> currentResult = _BFS(0);
+            maxDistance = currentResult.first;
+            node1 = 0;
+            node2 = currentResult.second;
 
-            if (newCurrentResult.first > maxDistance) {
-                maxDistance = newCurrentResult.first;
-                node1 = i;
-                node2 = newCurrentResult.second;
+            for (int i = 1; i < _numberOfVertices; ++i)
+            {
+                pair <int, int> newCurrentResult = _BFS(i);
+
+                if (newCurrentResult.first > maxDistance) {
+                    maxDistance = newCurrentResult.first;
+                    node1 = i;
+                    node2 = newCurrentResult.second;
+                }
             }
         }
 
+        AE_PHASE("output");
         cout << maxDistance << "\n";
         cout << node1 + 1 << " " << node2 + 1 << "\n";
     }
 };
 
 
-int main()
+int main(int argc, char *argv[])
 {
     // Improve the performance of cin
     ios_base::sync_with_stdio(false);
     cin.tie(NULL);
 
-    string path = "/Users/jan/Documents/code/ae/";
-    ifstream file(path + "example10.txt");
-    if (!file.is_open())
+    // Read from the file given as first argument, or from standard input
+    GraphReader file(argc > 1 ? argv[1] : nullptr);
+    if (!file.isOpen())
     {
         cerr << "Failed to open the file." << endl;
         return 1;
     }
 
-    // Read the number of nodes and edges from standard input
+    // Read the number of nodes and edges
     int numberOfNodes, numberOfEdges;
     file >> numberOfNodes >> numberOfEdges;
 
-    // Create a graph with the read number of nodes
-    Graph G(numberOfNodes, numberOfEdges);
-
-    // Read the edges from standard input and add them to the graph
-    for (int line = 0; line < numberOfEdges * 2; ++line)
+    // Read the edges and create a graph with the read number of nodes
+    Graph G(file.readGraph(numberOfNodes, 2 * static_cast<int64_t>(numberOfEdges)));
+    if (!file)
     {
-        int source, destination, weight;
-        file >> source >> destination >> weight;
-        G.addEdge(source, destination);
+        cerr << "Invalid graph input." << endl;
+        return 1;
     }
 
     G.findDiameter();
@@ -3,48 +3,99 @@
 #include <vector>
 #include <iostream>
 #include <algorithm>
+#include <atomic>
+
+#include "degree_statistics.h"
+#include "graph_reader.h"
+#include "instrumentation.h"
+
 using namespace std;
 
-int main()
+/**
+ * @struct PendingRun
+ * @brief Arcs with the same source a thread has read but not yet added to the shared counters.
+ *
+ * Inputs that list the arcs grouped by source, like the examples and snapshots, then cost one atomic
+ * add per vertex and chunk instead of one per arc. Padded to a cache line so threads do not share one.
+ */
+struct alignas(64) PendingRun
 {
+    int source = -1;              // Source of the run, -1 if it is empty
+    long long degree = 0;         // Number of arcs in the run
+    long long weightedDegree = 0; // Total weight of the arcs in the run
+};
 
-    int n, m;
-    cin >> n >> m;
+int main(int argc, char *argv[])
+{
+    // Read from the file given as first argument, or from standard input
+    GraphReader file(argc > 1 ? argv[1] : nullptr);
+    if (!file.isOpen())
+    {
+        cerr << "Failed to open the file." << endl;
+        return 1;
+    }
 
-    vector<int> degree(n, 0);
-    vector<int> weightedDegree(n, 0);
-    int totalWeight = 0;
+    int n = 0, m = 0;
+    file >> n >> m;
 
-    // Loop through each edge from the input
-    for (int i = 0; i < (m * 2); i++)
+    // Only the per-vertex counters are kept, the edges are never stored
+    vector<atomic<long long> > degree(n);
+    vector<atomic<long long> > weightedDegree(n);
+    vector<PendingRun> runs(numberOfThreads());
+    auto flush = [&](PendingRun &run)
     {
-        int source, destination, weight;
-        cin >> source >> destination >> weight;
-        source -= 1;                      // Adjust fot 0-based indexing
-        degree[source] += 1;              // Increment the degree of the source node
-        weightedDegree[source] += weight; // Add the weight to the weighted degree
-
-        // Get total edge weight
-        totalWeight += weight;
-    }
+        if (run.source >= 0)
+        {
+            degree[run.source].fetch_add(run.degree, memory_order_relaxed);
+            weightedDegree[run.source].fetch_add(run.weightedDegree, memory_order_relaxed);
+        }
+        run = PendingRun();
+    };
 
-    // Get the maximum degree by selecting the largest degree element
-    int maxDegree = *max_element(degree.begin(), degree.end());
+    // Stream over the edges in parallel chunks, every thread adds up its arcs until the source changes
+    file.forEachEdge(n, 2 * static_cast<int64_t>(m), [&](int threadID, int64_t, int source, int, int weight)
+                     {
+                         PendingRun &run = runs[threadID];
+                         if (source != run.source)
+                         {
+                             flush(run);
+                             run.source = source;
+                         }
+                         run.degree += 1;
+                         run.weightedDegree += weight;
+                     });
+    for (PendingRun &run : runs)
+        flush(run);
 
-    // Get the minimum degree by selecting the smalles degree element
-    int minDegree = *min_element(degree.begin(), degree.end());
+    if (!file)
+    {
+        cerr << "Invalid graph input." << endl;
+        return 1;
+    }
 
-    // Get the maximum weighted degree by selecting the largest weighted degree element
-    int maxWeightedDegree = *max_element(weightedDegree.begin(), weightedDegree.end());
+    DegreeStatistics total;
+    {
+        AE_PHASE("algorithm");
 
-    // Get the minimum weighted degree by selecting the largest smalles degree element
-    int minWeightedDegree = *min_element(weightedDegree.begin(), weightedDegree.end());
+        // Reduce the degrees to their extremes and the total weight, one block of vertices per thread
+        vector<DegreeStatistics> partial(numberOfThreads());
+        parallelFor(0, n, [&](int threadID, int64_t first, int64_t last)
+                    {
+                        for (int64_t vertex = first; vertex < last; ++vertex)
+                            partial[threadID].add(degree[vertex].load(memory_order_relaxed), weightedDegree[vertex].load(memory_order_relaxed));
+                    });
+
+        // Merge the per-thread results
+        for (const DegreeStatistics &result : partial)
+            total.merge(result);
+    }
 
-    cout << maxDegree << endl;
-    cout << minDegree << endl;
-    cout << maxWeightedDegree << endl;
-    cout << minWeightedDegree << endl;
-    cout << totalWeight / 2 << endl; // Must divide by 2 because we count the weight of both directions
+    AE_PHASE("output");
+    cout << total.maxDegree << endl;
+    cout << total.minDegree << endl;
+    cout << total.maxWeightedDegree << endl;
+    cout << total.minWeightedDegree << endl;
+    cout << total.totalWeight / 2 << endl; // Must divide by 2 because we count the weight of both directions
 
     return 0;
-}
\ No newline at end of file
+}
@@ -3,73 +3,117 @@
 #include <vector>
 #include <iostream>
 #include <algorithm>
-#include <fstream>
+
+#include "graph_reader.h"
+#include "instrumentation.h"
+#include "parallel.h"
+
 using namespace std;
 
-int main()
+// metrics of one partition
+struct PartitionMetrics
 {
-    // get graph metrics
-    int n, m, k;
-    cin >> n >> m >> k;
+    long long edgeCut = 0;
+    long long weightedEdgeCut = 0;
+    double balance = 0;
+};
 
-    // create data structures: 2D vector for edges, normal vector for partition of each node
-    vector<vector<int>> edges(n, vector<int>(n, 0));
-    vector<int> partitions(n);
+// evaluates a k-way partition in one parallel pass over the edge array and the vertices
+PartitionMetrics evaluatePartition(const vector<InputEdge> &edges, const vector<int> &partitions, int k)
+{
+    AE_PHASE("algorithm");
+    int n = static_cast<int>(partitions.size());
+    int64_t arcs = static_cast<int64_t>(edges.size());
+    int threads = static_cast<int>(min<int64_t>(numberOfThreads(), max<int64_t>(1, (arcs + n) >> 14)));
 
-    int edge_cut = 0;
-    int weighted_edge_cut = 0;
+    // per-thread partial results, each thread owns one block of the edges and one block of the vertices
+    vector<long long> partEdgeCut(threads, 0);
+    vector<long long> partWeightedEdgeCut(threads, 0);
+    vector<vector<long long> > partSizes(threads);
 
-    // get edge data
-    for (int i = 0; i < m * 2; i++)
-    {
-        int source, destination, weight;
-        cin >> source >> destination >> weight;
-        edges[source - 1][destination - 1] = weight;
-    }
+    parallelRun(threads, [&](int threadID)
+                {
+                    long long edgeCut = 0;
+                    long long weightedEdgeCut = 0;
+                    for (int64_t i = arcs * threadID / threads; i < arcs * (threadID + 1) / threads; i++)
+                    {
+                        const InputEdge &edge = edges[i];
+                        bool cut = partitions[edge.source] != partitions[edge.destination]; // find edges between different partitions
+                        edgeCut += cut;
+                        weightedEdgeCut += cut ? edge.weight : 0;
+                    }
+                    partEdgeCut[threadID] = edgeCut;
+                    partWeightedEdgeCut[threadID] = weightedEdgeCut;
 
-    // get node partition information
-    for (int i = 0; i < n; i++)
-    {
-        cin >> partitions[i];
-    }
+                    vector<long long> &sizes = partSizes[threadID];
+                    sizes.assign(k, 0);
+                    for (int64_t i = static_cast<int64_t>(n) * threadID / threads; i < static_cast<int64_t>(n) * (threadID + 1) / threads; i++)
+                        sizes[partitions[i]] += 1;
+                });
 
-    // compare each node with each other
-    for (int i = 0; i < n; i++)
+    // merge the partial results
+    PartitionMetrics metrics;
+    vector<long long> blockSizes(k, 0);
+    for (int threadID = 0; threadID < threads; threadID++)
     {
-        for (int j = 0; j < n; j++)
-        {
-            if (partitions[i] != partitions[j]) // find nodes in different partitions
-            {
-                if (edges[i][j] != 0)
-                { // check if nodes are connected
-                    edge_cut += 1;
-                }
-                weighted_edge_cut += edges[i][j];
-            }
-        }
+        metrics.edgeCut += partEdgeCut[threadID];
+        metrics.weightedEdgeCut += partWeightedEdgeCut[threadID];
+        for (int block = 0; block < k; block++)
+            blockSizes[block] += partSizes[threadID][block];
     }
 
+    // cut all weights in half, because each edge was added twice #efficiency
+    metrics.edgeCut /= 2;
+    metrics.weightedEdgeCut /= 2;
+
     // search for biggest partition
-    vector<int> partSizes(k, 0);
+    double max_partition_size = *max_element(blockSizes.begin(), blockSizes.end());
+    double ideal_partition_size = (double)n / (double)k;
+    metrics.balance = max_partition_size / ideal_partition_size;
 
-    for (int i = 0; i < n; i++)
+    return metrics;
+}
+
+int main(int argc, char *argv[])
+{
+    // read from the file given as first argument, or from standard input
+    GraphReader file(argc > 1 ? argv[1] : nullptr);
+    if (!file.isOpen())
     {
-        partSizes[partitions[i]] += 1;
+        cerr << "Failed to open the file." << endl;
+        return 1;
     }
 
-    // cut all weights in half, because each edge was added twice #efficiency
-    edge_cut /= 2;
-    weighted_edge_cut /= 2;
+    // get graph metrics
+    int n, m, k;
+    file >> n >> m >> k;
 
-    double max_partition_size = *max_element(partSizes.begin(), partSizes.end());
+    // get edge data, both directions of every edge are kept like in the input
+    vector<InputEdge> edges = file.readEdges(n, 2 * static_cast<int64_t>(m));
+    if (!file)
+    {
+        cerr << "Invalid graph input." << endl;
+        return 1;
+    }
 
-    double ideal_partition_size = (float)n / (float)k;
+    // score every partition that follows the edges, each one holds one block ID per line
+    while (true)
+    {
+        vector<int> partitions = file.readValues(n);
+        if (static_cast<int>(partitions.size()) < n || n == 0)
+            break;
 
-    double balance = max_partition_size / ideal_partition_size;
+        if (any_of(partitions.begin(), partitions.end(), [k](int block) { return block < 0 || block >= k; }))
+        {
+            cerr << "Invalid block ID in partition." << endl;
+            return 1;
+        }
 
-    cout << edge_cut << endl;
-    cout << weighted_edge_cut << endl;
-    cout << balance << endl;
+        PartitionMetrics metrics = evaluatePartition(edges, partitions, k);
+        cout << metrics.edgeCut << endl;
+        cout << metrics.weightedEdgeCut << endl;
+        cout << metrics.balance << endl;
+    }
 
     return 0;
 }
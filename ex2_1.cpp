@@ -3,17 +3,211 @@
 #include <vector>
 #include <iostream>
 #include <algorithm>
-#include <fstream>
+#include <string>
+#include <atomic>
+#include <chrono>
+#include <random>
+
+#include "bucket_queue.h"
+#include "csr_graph.h"
+#include "degree_statistics.h"
+#include "graph_reader.h"
+#include "instrumentation.h"
+#include "parallel.h"
+#include "result_writer.h"
+#include "set_intersection.h"
 
 using namespace std;
 
-struct Edge
+/**
+ * @struct PartitionMetrics
+ * @brief Quality of a k-way partition.
+ */
+struct PartitionMetrics
+{
+    long long edgeCut = 0;         // Number of edges between different blocks
+    long long weightedEdgeCut = 0; // Total weight of the edges between different blocks
+    vector<int64_t> blockSizes;    // Number of vertices in every block
+
+    /**
+     * @brief Returns the size of the largest block relative to a perfectly balanced block
+     */
+    double balance() const
+    {
+        int64_t vertices = 0, maxBlockSize = 0;
+        for (int64_t blockSize : blockSizes)
+        {
+            vertices += blockSize;
+            maxBlockSize = max(maxBlockSize, blockSize);
+        }
+        return vertices ? static_cast<double>(maxBlockSize) / (vertices / static_cast<double>(blockSizes.size())) : 0.0;
+    }
+};
+
+/**
+ * @class PartitionState
+ * @brief A k-way partition of a graph that keeps its metrics up to date while vertices move.
+ *
+ * The cut, the weighted cut and the block sizes are evaluated once in a fused parallel pass. After that
+ * moving a vertex only looks at its own arcs, so refinement pays O(degree) per move instead of O(m)
+ * for a fresh evaluation. The graph must hold both directions of every edge.
+ */
+class PartitionState
 {
-    int source;
-    int destination;
-    int weight;
+private:
+    const CSRGraph &_graph;       // Partitioned graph
+    vector<int> _partition;       // Block of every vertex
+    PartitionMetrics _metrics;    // Metrics of the current partition
+    vector<int> _pendingBlocks;   // New block of every vertex in the running batch, -1 otherwise
+
+public:
+    /**
+     * @brief Evaluates a partition in one pass over the arcs and the vertices.
+     *
+     * Every thread owns one block of vertices, counts the cut arcs leaving them and the sizes of the
+     * blocks, then the partial results are merged.
+     *
+     * @param graph The graph.
+     * @param partition The block of every vertex.
+     * @param numberOfBlocks The number of blocks, 0 to skip the block sizes.
+     * @param threads The number of threads, 1 inside code that already runs in parallel.
+     * @return The metrics.
+     */
+    static PartitionMetrics evaluate(const CSRGraph &graph, const vector<int> &partition, int numberOfBlocks, int threads = numberOfThreads())
+    {
+        int n = graph.numberOfVertices();
+        threads = static_cast<int>(min<int64_t>(threads, max<int64_t>(1, (graph.numberOfArcs() + n) >> 14)));
+        vector<PartitionMetrics> partial(threads);
+
+        parallelRun(threads, [&](int threadID)
+                    {
+                        PartitionMetrics &metrics = partial[threadID];
+                        metrics.blockSizes.assign(numberOfBlocks, 0);
+                        for (int64_t vertex = static_cast<int64_t>(n) * threadID / threads; vertex < static_cast<int64_t>(n) * (threadID + 1) / threads; ++vertex)
+                        {
+                            int block = partition[vertex];
+                            for (int64_t arc = graph.firstArc(vertex); arc < graph.lastArc(vertex); ++arc)
+                            {
+                                bool cut = partition[graph.target(arc)] != block;
+                                metrics.edgeCut += cut;
+                                metrics.weightedEdgeCut += cut ? graph.weight(arc) : 0;
+                            }
+                            if (numberOfBlocks > 0)
+                                metrics.blockSizes[block] += 1;
+                        }
+                    });
+
+        // Merge the partial results, every cut edge was counted from both sides
+        PartitionMetrics metrics = std::move(partial[0]);
+        for (int threadID = 1; threadID < threads; ++threadID)
+        {
+            metrics.edgeCut += partial[threadID].edgeCut;
+            metrics.weightedEdgeCut += partial[threadID].weightedEdgeCut;
+            for (int block = 0; block < numberOfBlocks; ++block)
+                metrics.blockSizes[block] += partial[threadID].blockSizes[block];
+        }
+        metrics.edgeCut /= 2;
+        metrics.weightedEdgeCut /= 2;
+        return metrics;
+    }
+
+    /**
+     * @brief Creates the state of a partition.
+     * @param graph The graph, must outlive the state.
+     * @param partition The block of every vertex.
+     * @param numberOfBlocks The number of blocks.
+     */
+    PartitionState(const CSRGraph &graph, vector<int> partition, int numberOfBlocks)
+        : _graph(graph), _partition(std::move(partition)), _metrics(evaluate(graph, _partition, numberOfBlocks)),
+          _pendingBlocks(graph.numberOfVertices(), -1)
+    {
+    }
+
+    int block(int vertex) const { return _partition[vertex]; }
+    const vector<int> &partition() const { return _partition; }
+    const PartitionMetrics &metrics() const { return _metrics; }
+    long long edgeCut() const { return _metrics.edgeCut; }
+    long long weightedEdgeCut() const { return _metrics.weightedEdgeCut; }
+    int64_t blockSize(int block) const { return _metrics.blockSizes[block]; }
+    double balance() const { return _metrics.balance(); }
+
+    /**
+     * @brief Moves a vertex to another block in O(degree).
+     * @param vertex The vertex.
+     * @param newBlock The block to move it to.
+     */
+    void move(int vertex, int newBlock)
+    {
+        int oldBlock = _partition[vertex];
+        if (oldBlock == newBlock)
+            return;
 
-    Edge(int src, int dest, int w) : source(src), destination(dest), weight(w) {}
+        for (int64_t arc = _graph.firstArc(vertex); arc < _graph.lastArc(vertex); ++arc)
+        {
+            int destination = _graph.target(arc);
+            if (destination == vertex)
+                continue;
+
+            int change = (newBlock != _partition[destination]) - (oldBlock != _partition[destination]);
+            _metrics.edgeCut += change;
+            _metrics.weightedEdgeCut += change * static_cast<long long>(_graph.weight(arc));
+        }
+
+        _metrics.blockSizes[oldBlock] -= 1;
+        _metrics.blockSizes[newBlock] += 1;
+        _partition[vertex] = newBlock;
+    }
+
+    /**
+     * @brief Moves many vertices at once, the metric changes are summed in parallel.
+     *
+     * An edge between two moved vertices is accounted for once, from its endpoint with the smaller ID,
+     * using the new blocks of both. Costs O(sum of the degrees of the moved vertices).
+     *
+     * @param moves Pairs of vertex and new block, every vertex at most once.
+     */
+    void move(const vector<pair<int, int> > &moves)
+    {
+        int64_t count = static_cast<int64_t>(moves.size());
+        for (const pair<int, int> &vertexMove : moves)
+            _pendingBlocks[vertexMove.first] = vertexMove.second;
+
+        vector<PartitionMetrics> partial(numberOfThreads());
+        parallelFor(0, count, [&](int threadID, int64_t first, int64_t last)
+                    {
+                        PartitionMetrics &change = partial[threadID];
+                        for (int64_t i = first; i < last; ++i)
+                        {
+                            int vertex = moves[i].first;
+                            int oldBlock = _partition[vertex], newBlock = moves[i].second;
+                            for (int64_t arc = _graph.firstArc(vertex); arc < _graph.lastArc(vertex); ++arc)
+                            {
+                                int destination = _graph.target(arc);
+                                bool destinationMoved = _pendingBlocks[destination] != -1;
+                                if (destination == vertex || (destinationMoved && destination < vertex))
+                                    continue;
+
+                                int destinationNewBlock = destinationMoved ? _pendingBlocks[destination] : _partition[destination];
+                                int difference = (newBlock != destinationNewBlock) - (oldBlock != _partition[destination]);
+                                change.edgeCut += difference;
+                                change.weightedEdgeCut += difference * static_cast<long long>(_graph.weight(arc));
+                            }
+                        }
+                    }, 1 << 10);
+
+        for (const PartitionMetrics &change : partial)
+        {
+            _metrics.edgeCut += change.edgeCut;
+            _metrics.weightedEdgeCut += change.weightedEdgeCut;
+        }
+        for (const pair<int, int> &vertexMove : moves)
+        {
+            _metrics.blockSizes[_partition[vertexMove.first]] -= 1;
+            _metrics.blockSizes[vertexMove.second] += 1;
+            _partition[vertexMove.first] = vertexMove.second;
+            _pendingBlocks[vertexMove.first] = -1;
+        }
+    }
 };
 
 /**
@@ -26,7 +220,16 @@ class Graph
 {
 private:
     int _numberOfVertices;
-    vector<vector<Edge> > _adjacencyList;
+    CSRGraph _graph;
+    vector<long long> _weightedDegrees; // Weighted degree of every vertex
+    int _minDegree = 0;                 // Minimum degree
+    int _maxDegree = 0;                 // Maximum degree
+    long long _minWeightedDegree = 0;   // Minimum weighted degree
+    long long _maxWeightedDegree = 0;   // Maximum weighted degree
+    long long _maxAbsoluteWeightedDegree = 0; // Maximum sum of absolute arc weights of a vertex, bounds cut gains
+    long long _totalWeight = 0;         // Total edge weight
+    vector<int64_t> _sortedOffsets; // First entry of every vertex in _sortedNeighbors, plus one sentinel
+    vector<int> _sortedNeighbors;   // Sorted, duplicate-free neighborhoods without the vertex itself
 
     /**
      * @brief Computes random initial cut of the max cut problem.
@@ -57,19 +260,24 @@ private:
         return cut;
     }
 
-    int findOptimalVertexForRandomCut(vector<int> partition)
+    /**
+     * @brief Finds a vertex on side 0 next to the side 1 vertex of highest weighted degree.
+     * @param partition The side of every vertex.
+     * @return The vertex, found in O(m) with the cached weighted degrees.
+     */
+    int findOptimalVertexForRandomCut(const vector<int> &partition) const
     {
-        int highestWeight = -1;
+        long long highestWeight = -1;
         int optimalVertex = -1;
 
         for (int vertex = 0; vertex < _numberOfVertices; ++vertex)
         {
             if (partition[vertex] == 0)
             {
-                for (const Edge &edge : _adjacencyList[vertex])
+                for (int destination : _graph.neighbors(vertex))
                 {
-                    int destinationWeight = getWeightedDegree(edge.destination);
-                    if (highestWeight < destinationWeight && partition[edge.destination] == 1)
+                    long long destinationWeight = getWeightedDegree(destination);
+                    if (highestWeight < destinationWeight && partition[destination] == 1)
                     {
                         highestWeight = destinationWeight;
                         optimalVertex = vertex;
@@ -87,145 +295,143 @@ private:
     }
 
     /**
-     * @brief Finds the neighborhood of a given vertex.
-     * @param vertex The vertex for which to find the neighborhood.
-     * @return The vector of neighboring vertices.
+     * @brief Computes the weighted degrees and all degree statistics in one parallel pass over the arcs.
+     *
+     * The graph does not change after construction, so the statistics are computed once and the
+     * queries only return the cached values.
      */
-    vector<int> findNeighborhood(int vertex)
+    void computeDegreeStatistics()
     {
-        vector<int> neighborhood;
-        for (const Edge &edge : _adjacencyList[vertex])
-        {
-            if (edge.destination != vertex - 1) // Exclude the source vertex itself
-            {
-                neighborhood.push_back(edge.destination);
-            }
-        }
+        _weightedDegrees.assign(_numberOfVertices, 0);
+        vector<DegreeStatistics> partial(numberOfThreads());
+        parallelFor(0, _numberOfVertices, [&](int threadID, int64_t first, int64_t last)
+                    {
+                        DegreeStatistics &result = partial[threadID];
+                        for (int64_t vertex = first; vertex < last; ++vertex)
+                        {
+                            long long weightedDegree = 0, absoluteWeightedDegree = 0;
+                            for (int64_t arc = _graph.firstArc(vertex); arc < _graph.lastArc(vertex); ++arc)
+                            {
+                                weightedDegree += _graph.weight(arc);
+                                absoluteWeightedDegree += abs(_graph.weight(arc));
+                            }
+                            _weightedDegrees[vertex] = weightedDegree;
 
-        // Sort the neighborhood
-        sort(neighborhood.begin(), neighborhood.end());
+                            result.add(_graph.degree(vertex), weightedDegree);
+                            result.maxAbsoluteWeightedDegree = max(result.maxAbsoluteWeightedDegree, absoluteWeightedDegree);
+                        }
+                    });
 
-        // Remove duplicates
-        neighborhood.erase(unique(neighborhood.begin(), neighborhood.end()), neighborhood.end());
+        // Merge the per-thread results
+        DegreeStatistics total;
+        for (const DegreeStatistics &result : partial)
+            total.merge(result);
 
-        return neighborhood;
-}
+        // An empty graph has all statistics 0
+        bool empty = _numberOfVertices == 0;
+        _minDegree = empty ? 0 : static_cast<int>(total.minDegree);
+        _maxDegree = empty ? 0 : static_cast<int>(total.maxDegree);
+        _minWeightedDegree = empty ? 0 : total.minWeightedDegree;
+        _maxWeightedDegree = empty ? 0 : total.maxWeightedDegree;
+        _maxAbsoluteWeightedDegree = total.maxAbsoluteWeightedDegree;
+        _totalWeight = total.totalWeight / 2; // Both directions of every edge were added
+    }
+
+    /**
+     * @brief Builds the sorted, duplicate-free neighborhood of every vertex once, without the vertex itself.
+     *
+     * The arcs of every vertex are copied, sorted and deduplicated in parallel, then the ranges are
+     * compacted into one contiguous array with a prefix sum over their new lengths.
+     */
+    void buildSortedNeighborhoods()
+    {
+        vector<int> neighbors(_graph.targets(), _graph.targets() + _graph.numberOfArcs());
+        vector<int64_t> lengths(_numberOfVertices + 1, 0);
+
+        parallelFor(0, _numberOfVertices, [&](int, int64_t first, int64_t last)
+                    {
+                        for (int64_t vertex = first; vertex < last; ++vertex)
+                        {
+                            int *begin = neighbors.data() + _graph.firstArc(vertex);
+                            int *end = neighbors.data() + _graph.lastArc(vertex);
+                            sort(begin, end);
+                            end = unique(begin, end);
+                            end = remove(begin, end, static_cast<int>(vertex)); // Exclude the vertex itself
+                            lengths[vertex + 1] = end - begin;
+                        }
+                    }, 1 << 10);
+
+        for (int vertex = 0; vertex < _numberOfVertices; ++vertex)
+            lengths[vertex + 1] += lengths[vertex];
+
+        _sortedNeighbors.resize(lengths[_numberOfVertices]);
+        parallelFor(0, _numberOfVertices, [&](int, int64_t first, int64_t last)
+                    {
+                        for (int64_t vertex = first; vertex < last; ++vertex)
+                            copy(neighbors.begin() + _graph.firstArc(vertex), neighbors.begin() + _graph.firstArc(vertex) + (lengths[vertex + 1] - lengths[vertex]),
+                                 _sortedNeighbors.begin() + lengths[vertex]);
+                    }, 1 << 10);
+
+        _sortedOffsets = move(lengths);
+    }
 
 public:
     /**
-     * @brief Constructs a Graph object with the specified number of vertices.
-     * @param vertices The number of vertices in the graph.
+     * @brief Constructs a Graph object on top of a CSR graph.
+     * @param graph The graph structure.
      */
-    Graph(int vertices) : _numberOfVertices(vertices)
+    Graph(CSRGraph graph) : _numberOfVertices(graph.numberOfVertices()), _graph(move(graph))
     {
-        _adjacencyList.resize(_numberOfVertices);
+        computeDegreeStatistics();
+        buildSortedNeighborhoods();
     }
 
     /**
-     * @brief Adds an edge to the graph.
-     * @param source The source vertex of the edge.
-     * @param destination The destination vertex of the edge.
-     * @param weight The weight of the edge.
+     * @brief Returns the sorted neighborhood of a vertex, without duplicates and without the vertex itself
+     * @param vertex The vertex
+     * @return The range of neighbor IDs
      */
-    void addEdge(int source, int destination, int weight)
+    NeighborRange sortedNeighbors(int vertex) const
     {
-        _adjacencyList[source - 1].push_back(Edge(source - 1, destination - 1, weight));
+        return NeighborRange{_sortedNeighbors.data() + _sortedOffsets[vertex], _sortedNeighbors.data() + _sortedOffsets[vertex + 1]};
     }
 
     /**
      * @brief Returns the maximum degree of the graph
      * @return The maximum degree
      */
-    int getMaxDegree() const
-    {
-        int maxDegree = 0;
-
-        for (int vertex = 0; vertex < _numberOfVertices; ++vertex)
-            maxDegree = max(maxDegree, static_cast<int>(_adjacencyList[vertex].size()));
-
-        return maxDegree;
-    }
+    int getMaxDegree() const { return _maxDegree; }
 
     /**
      * @brief Returns the minimum degree of the graph
      * @return The minimum degree
      */
-    int getMinDegree() const
-    {
-        int minDegree = 1000;
-
-        for (int vertex = 0; vertex < _numberOfVertices; ++vertex)
-            minDegree = min(minDegree, static_cast<int>(_adjacencyList[vertex].size()));
-
-        return minDegree;
-    }
+    int getMinDegree() const { return _minDegree; }
 
     /**
      * @brief Returns the weighted degree of a vertex
      * @param vertex The vertex
      * @return The weighted degree of the vertex
      */
-    int getWeightedDegree(int vertex) const
-    {
-        int weightedDegree = 0;
-        for (const Edge &edge : _adjacencyList[vertex])
-        {
-            weightedDegree += edge.weight;
-        }
-
-        return weightedDegree;
-    }
+    long long getWeightedDegree(int vertex) const { return _weightedDegrees[vertex]; }
 
     /**
      * @brief Returns the maximum weighted degree of the graph
      * @return The maximum weighted degree
      */
-    int getMaxWeightedDegree() const
-    {
-        int maxWeightedDegree = 0;
-
-        for (int vertex = 0; vertex < _numberOfVertices; ++vertex)
-        {
-            maxWeightedDegree = max(maxWeightedDegree, getWeightedDegree(vertex));
-        }
-
-        return maxWeightedDegree;
-    }
+    long long getMaxWeightedDegree() const { return _maxWeightedDegree; }
 
     /**
      * @brief Returns the minimum weighted degree of the graph
      * @return The minimum weighted degree
      */
-    int getMinWeightedDegree() const
-    {
-        int minWeightedDegree = 1000;
-
-        for (int vertex = 0; vertex < _numberOfVertices; ++vertex)
-        {
-            minWeightedDegree = min(minWeightedDegree, getWeightedDegree(vertex));
-        }
-
-        return minWeightedDegree;
-    }
+    long long getMinWeightedDegree() const { return _minWeightedDegree; }
 
     /**
      * @brief Returns the total weight of the graph
      * @return The total weight
      */
-    int getTotalWeight() const
-    {
-        int totalWeight = 0;
-
-        for (int vertex = 0; vertex < _numberOfVertices; ++vertex)
-        {
-            for (const Edge &edge : _adjacencyList[vertex])
-            {
-                totalWeight += edge.weight;
-            }
-        }
-
-        return totalWeight / 2;
-    }
+    long long getTotalWeight() const { return _totalWeight; }
 
     /**
      * @brief Prints the graph.
@@ -239,9 +445,9 @@ public:
         for (int vertex = 0; vertex < _numberOfVertices; ++vertex)
         {
             cout << "Vertex " << vertex + 1 << endl;
-            for (const Edge &edge : _adjacencyList[vertex])
+            for (int64_t arc = _graph.firstArc(vertex); arc < _graph.lastArc(vertex); ++arc)
             {
-                cout << edge.source + 1 << " - " << edge.destination + 1 << " (weight: " << edge.weight << ")" << endl;
+                cout << vertex + 1 << " - " << _graph.target(arc) + 1 << " (weight: " << _graph.weight(arc) << ")" << endl;
             }
             cout << endl;
         }
@@ -252,22 +458,9 @@ public:
      * @param partition A vector containing the partition of each vertex.
      * @return The edge-cut of the partition.
      */
-    int getEdgeCut(const vector<int> &partition)
+    long long getEdgeCut(const vector<int> &partition) const
     {
-        int edgeCut = 0;
-        for (int vertex = 0; vertex < _numberOfVertices; ++vertex)
-        {
-            for (const Edge &edge : _adjacencyList[vertex])
-            {
-                int sourcePartition = partition[vertex];
-                int destPartition = partition[edge.destination];
-                if (sourcePartition != destPartition)
-                {
-                    edgeCut++;
-                }
-            }
-        }
-        return edgeCut / 2;
+        return PartitionState::evaluate(_graph, partition, 0).edgeCut;
     }
 
     /**
@@ -275,22 +468,9 @@ public:
      * @param partition A vector containing the partition of each vertex.
      * @return The weighted edge-cut of the partition.
      */
-    int getWeightedEdgeCut(const vector<int> &partition)
+    long long getWeightedEdgeCut(const vector<int> &partition) const
     {
-        int weightedEdgeCut = 0;
-        for (int vertex = 0; vertex < _numberOfVertices; ++vertex)
-        {
-            int sourcePartition = partition[vertex];
-            for (const Edge &edge : _adjacencyList[vertex])
-            {
-                int destPartition = partition[edge.destination];
-                if (sourcePartition != destPartition)
-                {
-                    weightedEdgeCut += edge.weight;
-                }
-            }
-        }
-        return weightedEdgeCut / 2;
+        return PartitionState::evaluate(_graph, partition, 0).weightedEdgeCut;
     }
 
     /**
@@ -299,88 +479,402 @@ public:
      * @param numberOfBlocks The number of blocks in the partition.
      * @return The balance of the partition.
      */
-    double getBalance(const vector<int> &partition, int numberOfBlocks)
+    double getBalance(const vector<int> &partition, int numberOfBlocks) const
     {
-        vector<int> blockSizes(numberOfBlocks, 0);
-        for (int vertex = 0; vertex < _numberOfVertices; ++vertex)
+        return PartitionState::evaluate(_graph, partition, numberOfBlocks).balance();
+    }
+
+    /**
+     * @brief Creates a partition state that keeps the metrics of a partition up to date under moves.
+     * @param partition The block of every vertex.
+     * @param numberOfBlocks The number of blocks.
+     * @return The state, tied to this graph.
+     */
+    PartitionState createPartitionState(vector<int> partition, int numberOfBlocks) const
+    {
+        return PartitionState(_graph, std::move(partition), numberOfBlocks);
+    }
+
+    /**
+     * @brief Applies batches of vertex moves to a partition and evaluates it after every batch.
+     *
+     * The partition is evaluated once, after that every batch only pays for the arcs of its vertices. A
+     * batch of one vertex is applied with the single move, larger ones with the parallel batch move.
+     *
+     * @param partition The block of every vertex.
+     * @param numberOfBlocks The number of blocks.
+     * @param batches The moves of every batch as pairs of vertex (0-indexed) and new block, every vertex
+     *                at most once per batch.
+     * @return The metrics of the partition followed by the metrics after every batch.
+     */
+    vector<PartitionMetrics> applyMoves(vector<int> partition, int numberOfBlocks, const vector<vector<pair<int, int> > > &batches) const
+    {
+        AE_PHASE("algorithm");
+        PartitionState state = createPartitionState(std::move(partition), numberOfBlocks);
+        vector<PartitionMetrics> metrics(1, state.metrics());
+        for (const vector<pair<int, int> > &batch : batches)
         {
-            blockSizes[partition[vertex]]++;
+            if (batch.size() == 1)
+                state.move(batch[0].first, batch[0].second);
+            else
+                state.move(batch);
+            metrics.push_back(state.metrics());
         }
-        int maxBlockSize = *max_element(blockSizes.begin(), blockSizes.end());
-        double balance = static_cast<double>(maxBlockSize) / (_numberOfVertices / static_cast<double>(numberOfBlocks));
-        return balance;
+        return metrics;
     }
 
+    /**
+     * @brief Prints the common neighbors and the union of the neighborhoods of two vertices.
+     * @param src The first vertex (1-indexed).
+     * @param dest The second vertex (1-indexed).
+     */
     void getNeighborhood(int src, int dest)
     {
-        auto neighborhood1 = findNeighborhood(src);
-        auto neighborhood2 = findNeighborhood(dest);
-
-        // Compute intersection
         vector<int> intersection;
-        set_intersection(neighborhood1.begin(), neighborhood1.end(),
-                        neighborhood2.begin(), neighborhood2.end(),
-                        back_inserter(intersection));
-
-        // Compute union
         vector<int> uni;
-        merge(neighborhood1.begin(), neighborhood1.end(),
-            neighborhood2.begin(), neighborhood2.end(),
-            back_inserter(uni));
+        {
+            AE_PHASE("algorithm");
+            NeighborRange neighborhood1 = sortedNeighbors(src - 1);
+            NeighborRange neighborhood2 = sortedNeighbors(dest - 1);
+
+            // Compute intersection
+            set_intersection(neighborhood1.begin(), neighborhood1.end(),
+                            neighborhood2.begin(), neighborhood2.end(),
+                            back_inserter(intersection));
+
+            // Compute union
+            set_union(neighborhood1.begin(), neighborhood1.end(),
+                      neighborhood2.begin(), neighborhood2.end(),
+                      back_inserter(uni));
+        }
 
         // Output results
+        AE_PHASE("output");
         for (const auto &value : intersection)
         {
-            cout << value << " ";
+            cout << value + 1 << " ";
         }
         cout << endl;
 
         for (const auto &value : uni)
         {
-            cout << value << " ";
+            cout << value + 1 << " ";
         }
         cout << endl;
     }
 
     /**
-     * @brief Computes the maximum cut of the graph.
+     * @struct NeighborhoodOverlap
+     * @brief Overlap of the neighborhoods of a vertex pair.
+     */
+    struct NeighborhoodOverlap
+    {
+        int64_t intersection; // Number of common neighbors
+        int64_t unionSize;    // Number of vertices adjacent to at least one of the pair
+        double jaccard;       // intersection / unionSize, 0 if both neighborhoods are empty
+    };
+
+    /**
+     * @brief Computes the neighborhood overlap of many vertex pairs in parallel.
+     * @param pairs The vertex pairs (0-indexed).
+     * @return The overlap of every pair, in the order of the pairs.
+     */
+    vector<NeighborhoodOverlap> computeNeighborhoodOverlaps(const vector<pair<int, int> > &pairs) const
+    {
+        AE_PHASE("algorithm");
+        vector<NeighborhoodOverlap> overlaps(pairs.size());
+        parallelFor(0, static_cast<int64_t>(pairs.size()), [&](int, int64_t first, int64_t last)
+                    {
+                        for (int64_t i = first; i < last; ++i)
+                        {
+                            NeighborRange a = sortedNeighbors(pairs[i].first);
+                            NeighborRange b = sortedNeighbors(pairs[i].second);
+                            int64_t common = intersectionSize(a.first, a.size(), b.first, b.size());
+                            int64_t unionSize = a.size() + b.size() - common;
+                            overlaps[i] = NeighborhoodOverlap{common, unionSize, unionSize ? static_cast<double>(common) / unionSize : 0.0};
+                        }
+                    }, 1 << 12);
+
+        return overlaps;
+    }
+
+    /**
+     * @struct TriangleStatistics
+     * @brief Triangle counts and clustering coefficients of the graph.
+     */
+    struct TriangleStatistics
+    {
+        int64_t triangles = 0;          // Number of triangles
+        int64_t wedges = 0;             // Number of paths of length two, sum of d(d-1)/2
+        double transitivity = 0;        // 3 * triangles / wedges
+        double averageClustering = 0;   // Mean local clustering coefficient over all vertices
+        vector<int64_t> vertexTriangles; // Number of triangles through every vertex
+    };
+
+    /**
+     * @brief Returns the local clustering coefficient of a vertex
+     * @param vertex The vertex
+     * @param triangles The number of triangles through the vertex
+     * @return 2 * triangles / (d * (d - 1)), 0 for vertices with fewer than two neighbors
+     */
+    double localClustering(int vertex, int64_t triangles) const
+    {
+        int64_t degree = sortedNeighbors(vertex).size();
+        return degree < 2 ? 0.0 : 2.0 * triangles / (static_cast<double>(degree) * (degree - 1));
+    }
+
+    /**
+     * @brief Counts all triangles and computes the clustering coefficients.
+     *
+     * Every edge is oriented from the endpoint of lower to the endpoint of higher (degree, ID) rank, so no
+     * out-neighborhood is longer than sqrt(2m). Each triangle u < v < w (by rank) is found exactly once at
+     * its arc u->v as a common out-neighbor w. forEachCommonElement() reports w by its position in the
+     * out-neighbors of u, which is the arc u->w, so the thread owning u credits all three corners without
+     * atomics: u directly, v and w through counters on the arcs u->v and u->w. A second pass adds the arc
+     * counters to the heads of the arcs.
      *
-     * This function initializes the cut and then iteratively improves it by toggling the partition of each vertex.
-     * The process stops when no more beneficial moves can be found.
+     * The kernel is chosen per pair (u, v) by the ratio of the list sizes: balanced lists are merged with
+     * SIMD, skewed ones are intersected by galloping through the longer list.
+     *
+     * @return The statistics.
      */
-    void computeMaxCut()
+    TriangleStatistics computeTriangleStatistics() const
+    {
+        AE_PHASE("algorithm");
+        auto ranksBelow = [this](int a, int b)
+        {
+            int64_t degreeA = sortedNeighbors(a).size(), degreeB = sortedNeighbors(b).size();
+            return degreeA < degreeB || (degreeA == degreeB && a < b);
+        };
+
+        // Oriented adjacency, filtering keeps the lists sorted by ID
+        vector<int64_t> outOffsets(_numberOfVertices + 1, 0);
+        vector<int> outNeighbors;
+        parallelFor(0, _numberOfVertices, [&](int, int64_t first, int64_t last)
+                    {
+                        for (int64_t vertex = first; vertex < last; ++vertex)
+                            for (int neighbor : sortedNeighbors(vertex))
+                                outOffsets[vertex + 1] += ranksBelow(static_cast<int>(vertex), neighbor);
+                    });
+        for (int vertex = 0; vertex < _numberOfVertices; ++vertex)
+            outOffsets[vertex + 1] += outOffsets[vertex];
+
+        outNeighbors.resize(outOffsets[_numberOfVertices]);
+        parallelFor(0, _numberOfVertices, [&](int, int64_t first, int64_t last)
+                    {
+                        for (int64_t vertex = first; vertex < last; ++vertex)
+                        {
+                            int64_t position = outOffsets[vertex];
+                            for (int neighbor : sortedNeighbors(vertex))
+                                if (ranksBelow(static_cast<int>(vertex), neighbor))
+                                    outNeighbors[position++] = neighbor;
+                        }
+                    });
+
+        // First pass: the triangles of every lowest vertex u, the arcs of u only ever get written by its thread
+        vector<int> headTriangles(outNeighbors.size(), 0);
+        vector<int64_t> vertexTriangles(_numberOfVertices, 0);
+        parallelForDynamic(0, _numberOfVertices, [&](int, int64_t first, int64_t last)
+                           {
+                               for (int64_t u = first; u < last; ++u)
+                               {
+                                   const int *uNeighbors = outNeighbors.data() + outOffsets[u];
+                                   int *uHeads = headTriangles.data() + outOffsets[u];
+                                   int64_t uSize = outOffsets[u + 1] - outOffsets[u];
+                                   for (int64_t i = 0; i < uSize; ++i)
+                                   {
+                                       int v = uNeighbors[i];
+                                       int common = 0;
+                                       forEachCommonElement(uNeighbors, uSize, outNeighbors.data() + outOffsets[v], outOffsets[v + 1] - outOffsets[v],
+                                                            [&](int64_t w)
+                                                            {
+                                                                ++uHeads[w];
+                                                                ++common;
+                                                            });
+                                       uHeads[i] += common;
+                                       vertexTriangles[u] += common;
+                                   }
+                               }
+                           });
+
+        // Second pass: hand the arc counters to their heads, a sequential sweep like the reduction below
+        for (int u = 0; u < _numberOfVertices; ++u)
+            for (int64_t arc = outOffsets[u]; arc < outOffsets[u + 1]; ++arc)
+                vertexTriangles[outNeighbors[arc]] += headTriangles[arc];
+
+        // Reduce the per-vertex counts
+        TriangleStatistics statistics;
+        statistics.vertexTriangles.resize(_numberOfVertices);
+        int64_t vertexTriangleSum = 0;
+        double clusteringSum = 0;
+        for (int vertex = 0; vertex < _numberOfVertices; ++vertex)
+        {
+            int64_t triangles = vertexTriangles[vertex];
+            int64_t degree = sortedNeighbors(vertex).size();
+            statistics.vertexTriangles[vertex] = triangles;
+            vertexTriangleSum += triangles;
+            statistics.wedges += degree * (degree - 1) / 2;
+            clusteringSum += localClustering(vertex, triangles);
+        }
+
+        statistics.triangles = vertexTriangleSum / 3;
+        statistics.transitivity = statistics.wedges ? 3.0 * statistics.triangles / statistics.wedges : 0.0;
+        statistics.averageClustering = _numberOfVertices ? clusteringSum / _numberOfVertices : 0.0;
+        return statistics;
+    }
+
+    /**
+     * @brief Computes the gain of every vertex, the change of the weighted cut if the vertex switched sides.
+     * @param partition The side of every vertex.
+     * @return The gain of every vertex.
+     */
+    vector<long long> computeGains(const vector<int> &partition) const
     {
-        vector<int> cutPartition = computeRandomInitialCut();
-        int localHighWeightedEdgeCut = getWeightedEdgeCut(cutPartition);
-        bool improved;
-        int numIterationsWithoutImprovement = 0;
-        cout << findOptimalVertexForRandomCut(cutPartition) << endl;
+        vector<long long> gains(_numberOfVertices, 0);
+        for (int vertex = 0; vertex < _numberOfVertices; ++vertex)
+            for (int64_t arc = _graph.firstArc(vertex); arc < _graph.lastArc(vertex); ++arc)
+            {
+                // Self-loops are never cut, whatever side the vertex is on
+                int destination = _graph.target(arc);
+                if (destination != vertex)
+                    gains[vertex] += partition[destination] == partition[vertex] ? _graph.weight(arc) : -_graph.weight(arc);
+            }
+
+        return gains;
+    }
 
-        do
+    /**
+     * @brief Moves a vertex to the other side and updates the gains of its neighbors in O(degree).
+     *
+     * A neighbor that was on the old side of the vertex loses twice the edge weight, one on the new side gains it.
+     *
+     * @param vertex The vertex to move.
+     * @param partition The side of every vertex.
+     * @param gains The gain of every vertex.
+     * @param queue The queue of unlocked vertices, keyed by gain.
+     */
+    void flipVertex(int vertex, vector<int> &partition, vector<long long> &gains, BucketQueue &queue) const
+    {
+        for (int64_t arc = _graph.firstArc(vertex); arc < _graph.lastArc(vertex); ++arc)
         {
-            improved = false;
+            int destination = _graph.target(arc);
+            if (destination == vertex)
+                continue;
+
+            gains[destination] += partition[destination] == partition[vertex] ? -2LL * _graph.weight(arc) : 2LL * _graph.weight(arc);
+            if (queue.contains(destination))
+                queue.update(destination, gains[destination]);
+        }
+
+        partition[vertex] ^= 1;
+        gains[vertex] = -gains[vertex];
+    }
+
+    /**
+     * @brief Improves a cut with Fiduccia-Mattheyses passes.
+     *
+     * Every pass repeatedly moves the unlocked vertex of highest gain, taken from a bucket queue, and locks it.
+     * Moves with negative gain are allowed so the search can leave local optima. A pass ends once
+     * stallLimit moves in a row did not improve on the best cut of the pass, then the moves after the best
+     * cut are undone. Passes are repeated until one finds no improvement. Every move costs O(degree).
+     *
+     * The queue is only allocated once and emptied in O(n) between passes. Callers with many cuts to improve
+     * pass their own queue from createGainQueue().
+     *
+     * @param partition The side of every vertex, improved in place.
+     * @param queue An empty queue from createGainQueue(), empty again on return.
+     * @param stallLimit The number of moves without improvement after which a pass stops.
+     * @return The increase of the weighted cut.
+     */
+    long long improveCut(vector<int> &partition, BucketQueue &queue, int stallLimit = 1000) const
+    {
+        vector<long long> gains = computeGains(partition);
 
+        long long totalImprovement = 0;
+        vector<int> moves;
+        while (true)
+        {
+            AE_COUNT("passes", 1);
+            queue.clear();
             for (int vertex = 0; vertex < _numberOfVertices; ++vertex)
+                queue.push(vertex, gains[vertex]);
+
+            long long improvement = 0;
+            long long bestImprovement = 0;
+            size_t bestMoves = 0;
+            moves.clear();
+
+            while (!queue.empty() && moves.size() - bestMoves < static_cast<size_t>(stallLimit))
             {
-                int oldPartition = cutPartition[vertex];
-                cutPartition[vertex] ^= 1; // Toggle partition for current vertex
-                int newWeightedEdgeCut = getWeightedEdgeCut(cutPartition);
+                int vertex = queue.pop();
+                improvement += gains[vertex];
+                flipVertex(vertex, partition, gains, queue);
+                moves.push_back(vertex);
+                AE_COUNT("flips", 1);
 
-                if (newWeightedEdgeCut > localHighWeightedEdgeCut)
-                {
-                    localHighWeightedEdgeCut = newWeightedEdgeCut;
-                    improved = true;
-                    numIterationsWithoutImprovement = 0;
-                }
-                else
+                if (improvement > bestImprovement)
                 {
-                    cutPartition[vertex] = oldPartition; // Revert partition change
+                    bestImprovement = improvement;
+                    bestMoves = moves.size();
                 }
             }
 
-            numIterationsWithoutImprovement++;
-        } while (improved && numIterationsWithoutImprovement < _numberOfVertices); // Stop if no improvement after one full iteration
+            // Undo the moves after the best cut of the pass
+            for (size_t move = moves.size(); move > bestMoves; --move)
+                flipVertex(moves[move - 1], partition, gains, queue);
+
+            totalImprovement += bestImprovement;
+            if (bestImprovement <= 0)
+                break;
+        }
+
+        queue.clear();
+        return totalImprovement;
+    }
+
+    /**
+     * @brief Improves a cut with Fiduccia-Mattheyses passes, see above, with a queue of its own.
+     */
+    long long improveCut(vector<int> &partition, int stallLimit = 1000) const
+    {
+        BucketQueue queue = createGainQueue();
+        return improveCut(partition, queue, stallLimit);
+    }
+
+    /**
+     * @brief Returns an empty queue for the gains of improveCut.
+     *
+     * Gains are bounded by the weighted degree of their vertex. Buckets are only used while there are at most
+     * four per vertex, otherwise finding the top bucket would cost O(weighted degree) per pass instead of O(n)
+     * and the queue falls back to its heap.
+     */
+    BucketQueue createGainQueue() const
+    {
+        return BucketQueue(_numberOfVertices, -_maxAbsoluteWeightedDegree, _maxAbsoluteWeightedDegree, 4LL * _numberOfVertices + 1);
+    }
+
+    /**
+     * @brief Computes the maximum cut of the graph.
+     *
+     * This function initializes the cut and then improves it with a gain-based local search.
+     * The process stops when a pass of the local search finds no improvement.
+     */
+    void computeMaxCut()
+    {
+        vector<int> cutPartition;
+        int optimalVertex;
+        long long localHighWeightedEdgeCut;
+        {
+            AE_PHASE("algorithm");
+            cutPartition = computeRandomInitialCut();
+            optimalVertex = findOptimalVertexForRandomCut(cutPartition);
+
+            localHighWeightedEdgeCut = getWeightedEdgeCut(cutPartition);
+            localHighWeightedEdgeCut += improveCut(cutPartition);
+        }
 
+        AE_PHASE("output");
+        cout << optimalVertex << endl;
         cout << localHighWeightedEdgeCut << endl;
 
         for (int i = 0; i < _numberOfVertices; i++)
@@ -391,17 +885,104 @@ public:
             }
         }
     }
+
+    /**
+     * @brief Computes a maximum cut from many random starts in parallel.
+     *
+     * Every thread owns a random number generator and a partition buffer. It claims start indices until
+     * the number of starts is reached or the time budget is used up, draws a uniformly random partition
+     * seeded by the start index, improves it with improveCut and keeps its best cut. The best cut of all
+     * threads is chosen at the end, ties go to the lowest start index, so the result for a fixed number of
+     * starts does not depend on the number of threads.
+     *
+     * @param threads The number of threads.
+     * @param starts The number of starts, 0 for as many as fit into the time budget.
+     * @param seconds The time budget in seconds, 0 for no budget. Running starts are finished.
+     * @param seed The seed of the random starts.
+     */
+    void computeMultiStartMaxCut(int threads, long long starts, double seconds, unsigned long long seed)
+    {
+        /**
+         * @struct ThreadResult
+         * @brief The best cut of one thread, padded to a cache line.
+         */
+        struct alignas(64) ThreadResult
+        {
+            long long weightedEdgeCut = -1; // Weight of the best cut, -1 if no start finished
+            long long start = -1;           // Start index of the best cut
+            vector<int> partition;          // Side of every vertex in the best cut
+        };
+
+        vector<ThreadResult> results(threads);
+        ThreadResult *best = &results[0];
+        {
+            AE_PHASE("algorithm");
+            if (starts <= 0 && seconds <= 0)
+                starts = threads;
+
+            atomic<long long> nextStart(0);
+            auto deadline = chrono::steady_clock::now() + chrono::duration<double>(seconds);
+
+            parallelRun(threads, [&](int threadID)
+                        {
+                            ThreadResult &result = results[threadID];
+                            mt19937_64 random;
+                            vector<int> partition(_numberOfVertices);
+                            BucketQueue queue = createGainQueue();
+
+                            while (true)
+                            {
+                                long long start = nextStart.fetch_add(1);
+                                if (starts > 0 && start >= starts)
+                                    break;
+                                if (seconds > 0 && start > 0 && chrono::steady_clock::now() >= deadline)
+                                    break;
+
+                                seed_seq sequence{seed, static_cast<unsigned long long>(start)};
+                                random.seed(sequence);
+                                for (int &side : partition)
+                                    side = static_cast<int>(random() >> 63);
+
+                                long long weightedEdgeCut = PartitionState::evaluate(_graph, partition, 0, 1).weightedEdgeCut + improveCut(partition, queue);
+                                AE_COUNT("starts", 1);
+
+                                if (weightedEdgeCut > result.weightedEdgeCut || (weightedEdgeCut == result.weightedEdgeCut && start < result.start))
+                                {
+                                    result.weightedEdgeCut = weightedEdgeCut;
+                                    result.start = start;
+                                    result.partition = partition;
+                                }
+                            }
+                        });
+
+            // Reduce the results of all threads
+            for (ThreadResult &result : results)
+                if (result.weightedEdgeCut > best->weightedEdgeCut || (result.weightedEdgeCut == best->weightedEdgeCut && result.start >= 0 && result.start < best->start))
+                    best = &result;
+        }
+
+        AE_PHASE("output");
+        cout << best->weightedEdgeCut << endl;
+
+        for (int i = 0; i < _numberOfVertices; i++)
+        {
+            if (!best->partition[i])
+            {
+                cout << i + 1 << " ";
+            }
+        }
+    }
 };
 
 /**
  * @brief The main function.
  * @return 0 on success, 1 on failure.
  */
-int main()
+int main(int argc, char *argv[])
 {
-    string path = "/Users/jan/Documents/code/AlgorithmEngineering/";
-    ifstream file(path + "example2_1.txt");
-    if (!file.is_open())
+    // Read from the file given as first argument, or from standard input
+    GraphReader file(argc > 1 ? argv[1] : nullptr);
+    if (!file.isOpen())
     {
         cerr << "Failed to open the file." << endl;
         return 1;
@@ -411,18 +992,149 @@ int main()
     int numberOfNodes, numberOfEdges;
     file >> numberOfNodes >> numberOfEdges;
 
-    Graph G(numberOfNodes);
+    // Read the edges and create a graph with the read number of nodes
+    Graph G(file.readGraph(numberOfNodes, 2 * static_cast<int64_t>(numberOfEdges)));
+    if (!file)
+    {
+        cerr << "Invalid graph input." << endl;
+        return 1;
+    }
+
+    // "ex2_1 <file|-> --max-cut" runs the max cut local search instead of the neighborhood query
+    if (argc > 2 && string(argv[2]) == "--max-cut")
+    {
+        G.computeMaxCut();
+        cout << endl;
+        return 0;
+    }
+
+    // "ex2_1 <file|-> --multi-start [--threads T] [--starts N] [--time-limit S] [--seed S]" runs many random starts
+    if (argc > 2 && string(argv[2]) == "--multi-start")
+    {
+        int threads = numberOfThreads();
+        long long starts = 0;
+        double seconds = 0;
+        unsigned long long seed = random_device()();
+        for (int i = 3; i + 1 < argc; i += 2)
+        {
+            string option = argv[i];
+            if (option == "--threads")
+                threads = max(1, atoi(argv[i + 1]));
+            else if (option == "--starts")
+                starts = atoll(argv[i + 1]);
+            else if (option == "--time-limit")
+                seconds = atof(argv[i + 1]);
+            else if (option == "--seed")
+                seed = strtoull(argv[i + 1], nullptr, 10);
+            else
+            {
+                cerr << "Unknown option " << option << "." << endl;
+                return 1;
+            }
+        }
+
+        G.computeMultiStartMaxCut(threads, starts, seconds, seed);
+        cout << endl;
+        return 0;
+    }
+
+    // "ex2_1 <file|-> --pairs" reads vertex pairs until the end of the input and prints
+    // "common neighbors, union size, Jaccard score" for every pair
+    if (argc > 2 && string(argv[2]) == "--pairs")
+    {
+        vector<pair<int, int> > pairs;
+        int v1 = 0, v2 = 0;
+        while (file >> v1 >> v2)
+        {
+            if (v1 < 1 || v1 > numberOfNodes || v2 < 1 || v2 > numberOfNodes)
+            {
+                cerr << "Invalid vertex pair." << endl;
+                return 1;
+            }
+            pairs.emplace_back(v1 - 1, v2 - 1);
+        }
+
+        vector<Graph::NeighborhoodOverlap> overlaps = G.computeNeighborhoodOverlaps(pairs);
 
-    // get edge data
-    for (int i = 0; i < numberOfEdges * 2; ++i)
+        AE_PHASE("output");
+        ResultWriter out;
+        for (const Graph::NeighborhoodOverlap &overlap : overlaps)
+            out << overlap.intersection << ' ' << overlap.unionSize << ' ' << overlap.jaccard << '\n';
+        return 0;
+    }
+
+    // "ex2_1 <file|-> --triangles [--per-vertex]" prints the number of triangles, the transitivity and the
+    // average local clustering coefficient, optionally followed by "triangles clustering" for every vertex
+    if (argc > 2 && string(argv[2]) == "--triangles")
+    {
+        Graph::TriangleStatistics statistics = G.computeTriangleStatistics();
+
+        AE_PHASE("output");
+        ResultWriter out;
+        out << statistics.triangles << '\n'
+            << statistics.transitivity << '\n'
+            << statistics.averageClustering << '\n';
+        if (argc > 3 && string(argv[3]) == "--per-vertex")
+            for (int vertex = 0; vertex < numberOfNodes; ++vertex)
+                out << statistics.vertexTriangles[vertex] << ' ' << G.localClustering(vertex, statistics.vertexTriangles[vertex]) << '\n';
+        return 0;
+    }
+
+    // "ex2_1 <file|-> --moves K" reads a K-way partition with one block ID per line, then batches of moves
+    // "c v1 b1 ... vc bc" until the end of the input, and prints "edge cut, weighted edge cut, balance"
+    // for the partition and after every batch
+    if (argc > 3 && string(argv[2]) == "--moves")
     {
-        int source, destination, weight;
-        file >> source >> destination >> weight;
-        G.addEdge(source, destination, weight); // 0-based indexing
+        int numberOfBlocks = atoi(argv[3]);
+        vector<int> partition = file.readValues(numberOfNodes);
+        if (numberOfBlocks < 1 || static_cast<int>(partition.size()) < numberOfNodes ||
+            any_of(partition.begin(), partition.end(), [numberOfBlocks](int block) { return block < 0 || block >= numberOfBlocks; }))
+        {
+            cerr << "Invalid partition." << endl;
+            return 1;
+        }
+
+        // A vertex may move at most once per batch, lastBatch remembers where it moved last
+        vector<vector<pair<int, int> > > batches;
+        vector<int64_t> lastBatch(numberOfNodes, -1);
+        int count = 0;
+        while (file >> count)
+        {
+            int64_t batchIndex = static_cast<int64_t>(batches.size());
+            vector<pair<int, int> > batch;
+            for (int i = 0; i < count; ++i)
+            {
+                int vertex = 0, block = -1;
+                if (!(file >> vertex >> block) || vertex < 1 || vertex > numberOfNodes || block < 0 || block >= numberOfBlocks ||
+                    lastBatch[vertex - 1] == batchIndex)
+                {
+                    cerr << "Invalid move." << endl;
+                    return 1;
+                }
+                lastBatch[vertex - 1] = batchIndex;
+                batch.emplace_back(vertex - 1, block);
+            }
+            batches.push_back(std::move(batch));
+        }
+
+        vector<PartitionMetrics> metrics = G.applyMoves(std::move(partition), numberOfBlocks, batches);
+
+        AE_PHASE("output");
+        ResultWriter out;
+        for (const PartitionMetrics &step : metrics)
+            out << step.edgeCut << '\n'
+                << step.weightedEdgeCut << '\n'
+                << step.balance() << '\n';
+        return 0;
     }
 
-    int v1, v2;
+    int v1 = 0, v2 = 0;
     file >> v1 >> v2;
+    if (v1 < 1 || v1 > numberOfNodes || v2 < 1 || v2 > numberOfNodes)
+    {
+        cerr << "Invalid vertex pair." << endl;
+        return 1;
+    }
 
     G.getNeighborhood(v1, v2);
 
@@ -1,48 +1,258 @@
 #include <cmath>
 #include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
 #include <vector>
+#include <numeric>
+#include <utility>
 #include <iostream>
 #include <algorithm>
 
+#include "bucket_queue.h"
+#include "csr_graph.h"
+#include "graph_reader.h"
+#include "instrumentation.h"
+#include "parallel.h"
+#include "result_writer.h"
+#include "spmv.h"
+#include "vertex_order.h"
+
 using namespace std;
 
 /**
- * @struct Edge
- * @brief Structure to represent an edge in the graph
- * @var Edge::destination
- * Member 'destination' represents the destination vertex of the edge
- * @var Edge::weight
- * Member 'weight' represents the weight of the edge
+ * @class CoarseLevel
+ * @brief One level of the multilevel hierarchy, a contracted graph with the arc interface of CSRGraph.
+ *
+ * Every coarse vertex is a matched pair or a single vertex of the finer level. A pair is matched along
+ * its heaviest edge and kept on opposite sides if that edge has a positive weight, on the same side
+ * otherwise, so every fine vertex stores whether its side is flipped relative to its coarse vertex.
+ * An edge between two fine vertices with different flips is cut exactly when their coarse vertices are
+ * on the same side, so it enters the coarse graph with a negated weight. Cuts of the coarse graph
+ * therefore differ from the cuts they project to only by a constant, and improving one improves the other.
  */
-struct Edge
+class CoarseLevel
 {
-    int destination; // Destination vertex of the edge
-    int weight;      // Weight of the edge
-    Edge() : destination(0), weight(0) {}
-    Edge(int dest, int w) : destination(dest), weight(w) {}
-};
+private:
+    vector<int64_t> _offsets;   // Index of the first arc of every coarse vertex, plus one sentinel
+    vector<int> _targets;       // Destination coarse vertex of every arc
+    vector<long long> _weights; // Signed weight of every arc, parallel edges are merged
+    vector<int> _mapping;       // Coarse vertex of every fine vertex times two, plus one if it is flipped
 
-/**
- * @struct Node
- * @brief Structure to represent a node in the graph
- * @var Node::id
- * Member 'id' represents the ID of the node
- * @var Node::degree
- * Member 'degree' represents the degree of the node (number of edges)
- * @var Node::weight
- * Member 'weight' represents the weight of the node
- */
-struct Node
-{
-    int id;     // ID of the node
-    int degree; // Degree of the node (number of edges)
-    int weight; // Weight of the node
-    Node() : id(0), degree(0), weight(0) {}
-    Node(int i, int deg, int w) : id(i), degree(deg), weight(w) {}
-    // Overload the '<' operator to compare nodes based on their weight
-    bool operator<(const Node &other) const
+public:
+    /**
+     * @brief Contracts a heavy-edge matching of a graph.
+     *
+     * The vertices are visited in random order and every unmatched vertex is matched with the unmatched
+     * neighbor behind the arc with the largest absolute weight, leftovers are then matched over two hops.
+     * The arcs of the coarse vertices are collected in parallel, every thread owning a contiguous block
+     * of coarse vertices, and parallel arcs are merged in a small hash table sized to the arcs of one
+     * coarse vertex, so the extra memory stays O(n + m).
+     *
+     * @param fine The graph of the finer level.
+     * @param generator The random number generator for the visiting order.
+     */
+    template <typename WeightedGraph>
+    CoarseLevel(const WeightedGraph &fine, mt19937_64 &generator)
     {
-        return weight > other.weight;
+        int n = fine.numberOfVertices();
+        _mapping.assign(n, -1);
+
+        // Heavy-edge matching
+        vector<int> order(n);
+        iota(order.begin(), order.end(), 0);
+        shuffle(order.begin(), order.end(), generator);
+
+        // Matched partner of every vertex times two, plus one if the pair goes on opposite sides
+        vector<int> partners(n, -1);
+        for (int vertex : order)
+        {
+            if (partners[vertex] != -1)
+                continue;
+
+            int partner = -1;
+            long long partnerWeight = 0;
+            for (int64_t arc = fine.firstArc(vertex); arc < fine.lastArc(vertex); ++arc)
+            {
+                int destination = fine.target(arc);
+                long long weight = fine.weight(arc);
+                if (destination != vertex && partners[destination] == -1 && llabs(weight) > llabs(partnerWeight))
+                {
+                    partner = destination;
+                    partnerWeight = weight;
+                }
+            }
+            if (partner == -1)
+                continue;
+
+            partners[vertex] = 2 * partner + (partnerWeight > 0);
+            partners[partner] = 2 * vertex + (partnerWeight > 0);
+        }
+
+        // Two-hop matching of the leftovers, such as the leaves of a star that can never be matched
+        // directly. Two vertices whose heaviest edges go to the same neighbor are placed on the sides
+        // those edges prefer, and isolated vertices are paired with each other.
+        vector<int> waiting(n + 1, -1);
+        for (int vertex : order)
+        {
+            if (partners[vertex] != -1)
+                continue;
+
+            int neighbor = n;
+            long long neighborWeight = 0;
+            for (int64_t arc = fine.firstArc(vertex); arc < fine.lastArc(vertex); ++arc)
+            {
+                if (fine.target(arc) != vertex && llabs(fine.weight(arc)) > llabs(neighborWeight))
+                {
+                    neighbor = fine.target(arc);
+                    neighborWeight = fine.weight(arc);
+                }
+            }
+
+            int side = neighborWeight > 0;
+            if (waiting[neighbor] == -1)
+            {
+                waiting[neighbor] = 2 * vertex + side;
+                continue;
+            }
+
+            int partner = waiting[neighbor] >> 1;
+            int flipped = (waiting[neighbor] & 1) != side;
+            partners[vertex] = 2 * partner + flipped;
+            partners[partner] = 2 * vertex + flipped;
+            waiting[neighbor] = -1;
+        }
+
+        // Number the coarse vertices in the order of their first fine vertex, which keeps the locality
+        // of the input order on every level
+        vector<pair<int, int> > members;
+        members.reserve(n);
+        for (int vertex = 0; vertex < n; ++vertex)
+        {
+            if (_mapping[vertex] != -1)
+                continue;
+
+            int coarseVertex = static_cast<int>(members.size());
+            _mapping[vertex] = 2 * coarseVertex;
+            if (partners[vertex] == -1)
+                members.emplace_back(vertex, -1);
+            else
+            {
+                _mapping[partners[vertex] >> 1] = 2 * coarseVertex + (partners[vertex] & 1);
+                members.emplace_back(vertex, partners[vertex] >> 1);
+            }
+        }
+
+        // Contraction
+        int coarseVertices = static_cast<int>(members.size());
+        _offsets.assign(coarseVertices + 1, 0);
+        int threads = static_cast<int>(min<int64_t>(numberOfThreads(), max<int64_t>(1, fine.numberOfArcs() >> 16)));
+        vector<vector<int> > localTargets(threads);
+        vector<vector<long long> > localWeights(threads);
+
+        parallelRun(threads, [&](int threadID)
+                    {
+                        // Open addressing table that merges the parallel arcs of one coarse vertex
+                        vector<int> slotTargets;
+                        vector<long long> slotWeights;
+                        vector<int> usedSlots;
+                        int first = static_cast<int>(static_cast<int64_t>(coarseVertices) * threadID / threads);
+                        int last = static_cast<int>(static_cast<int64_t>(coarseVertices) * (threadID + 1) / threads);
+                        int64_t blockArcs = 0;
+                        for (int coarseVertex = first; coarseVertex < last; ++coarseVertex)
+                            for (int member : {members[coarseVertex].first, members[coarseVertex].second})
+                                if (member != -1)
+                                    blockArcs += fine.lastArc(member) - fine.firstArc(member);
+                        localTargets[threadID].reserve(blockArcs);
+                        localWeights[threadID].reserve(blockArcs);
+
+                        for (int coarseVertex = first; coarseVertex < last; ++coarseVertex)
+                        {
+                            int64_t fineArcs = 0;
+                            for (int member : {members[coarseVertex].first, members[coarseVertex].second})
+                                if (member != -1)
+                                    fineArcs += fine.lastArc(member) - fine.firstArc(member);
+
+                            size_t tableSize = 16;
+                            while (tableSize < 2 * static_cast<size_t>(fineArcs))
+                                tableSize *= 2;
+                            if (slotTargets.size() < tableSize)
+                            {
+                                slotTargets.assign(tableSize, -1);
+                                slotWeights.assign(tableSize, 0);
+                            }
+                            size_t mask = tableSize - 1;
+
+                            usedSlots.clear();
+                            for (int member : {members[coarseVertex].first, members[coarseVertex].second})
+                            {
+                                if (member == -1)
+                                    continue;
+                                int memberFlip = _mapping[member] & 1;
+                                for (int64_t arc = fine.firstArc(member); arc < fine.lastArc(member); ++arc)
+                                {
+                                    int destination = fine.target(arc);
+                                    int destinationMapping = _mapping[destination];
+                                    int coarseDestination = destinationMapping >> 1;
+                                    if (coarseDestination == coarseVertex)
+                                        continue;
+
+                                    size_t slot = (static_cast<uint32_t>(coarseDestination) * 2654435769u) & mask;
+                                    while (slotTargets[slot] != -1 && slotTargets[slot] != coarseDestination)
+                                        slot = (slot + 1) & mask;
+                                    if (slotTargets[slot] == -1)
+                                    {
+                                        slotTargets[slot] = coarseDestination;
+                                        usedSlots.push_back(static_cast<int>(slot));
+                                    }
+                                    long long weight = fine.weight(arc);
+                                    slotWeights[slot] += ((memberFlip ^ destinationMapping) & 1) ? -weight : weight;
+                                }
+                            }
+
+                            // Emit the merged arcs in order of first appearance and clear the table
+                            size_t begin = localTargets[threadID].size();
+                            for (int slot : usedSlots)
+                            {
+                                if (slotWeights[slot] != 0)
+                                {
+                                    localTargets[threadID].push_back(slotTargets[slot]);
+                                    localWeights[threadID].push_back(slotWeights[slot]);
+                                }
+                                slotTargets[slot] = -1;
+                                slotWeights[slot] = 0;
+                            }
+                            _offsets[coarseVertex + 1] = localTargets[threadID].size() - begin;
+                        }
+                    });
+
+        partial_sum(_offsets.begin(), _offsets.end(), _offsets.begin());
+        _targets.resize(_offsets[coarseVertices]);
+        _weights.resize(_offsets[coarseVertices]);
+        parallelRun(threads, [&](int threadID)
+                    {
+                        int first = static_cast<int>(static_cast<int64_t>(coarseVertices) * threadID / threads);
+                        copy(localTargets[threadID].begin(), localTargets[threadID].end(), _targets.begin() + _offsets[first]);
+                        copy(localWeights[threadID].begin(), localWeights[threadID].end(), _weights.begin() + _offsets[first]);
+                    });
+    }
+
+    int numberOfVertices() const { return static_cast<int>(_offsets.size()) - 1; }
+    int64_t numberOfArcs() const { return _offsets.back(); }
+    int64_t firstArc(int vertex) const { return _offsets[vertex]; }
+    int64_t lastArc(int vertex) const { return _offsets[vertex + 1]; }
+    int degree(int vertex) const { return static_cast<int>(_offsets[vertex + 1] - _offsets[vertex]); }
+    int target(int64_t arc) const { return _targets[arc]; }
+    long long weight(int64_t arc) const { return _weights[arc]; }
+
+    /**
+     * @brief Returns the side of a fine vertex given the side of its coarse vertex
+     * @param fineVertex The vertex of the finer level.
+     * @param partition The side of every coarse vertex.
+     */
+    int project(int fineVertex, const vector<int> &partition) const
+    {
+        return partition[_mapping[fineVertex] >> 1] ^ (_mapping[fineVertex] & 1);
     }
 };
 
@@ -51,46 +261,257 @@ struct Node
  * @brief Class to represent a graph
  * @var Graph::_numberOfVertices
  * Member '_numberOfVertices' represents the number of vertices in the graph
- * @var Graph::_adjacencyList
- * Member '_adjacencyList' represents the adjacency list to represent the graph
- * @var Graph::_nodeList
- * Member '_nodeList' represents the list of nodes in the graph
+ * @var Graph::_graph
+ * Member '_graph' represents the CSR structure of the graph
  */
 class Graph
 {
 private:
     int _numberOfVertices;               // Number of vertices in the graph
-    vector<vector<Edge> > _adjacencyList; // Adjacency list to represent the graph
-    vector<Node> _nodeList;              // List of nodes in the graph
+    CSRGraph _graph;                     // CSR structure of the graph
 
-public:
-    // Constructor
-    Graph(int vertices) : _numberOfVertices(vertices)
+    /**
+     * @brief Assigns every vertex greedily in weighted-degree order
+     *
+     * A vertex joins the side it has less weight to among the vertices assigned before it. The weighted
+     * degree sums absolute weights, which only matters for the signed weights of coarse levels. With an
+     * initial partition every vertex with a side counts as assigned from the start and the pass reassigns
+     * them all in the same order, otherwise it is seeded with the two heaviest vertices.
+     *
+     * @param graph The graph, a CSRGraph or a CoarseLevel
+     * @param initialPartition The side of every vertex to start from, -1 for unassigned ones, or nullptr
+     * @return The side of every vertex
+     */
+    template <typename WeightedGraph>
+    static vector<int> greedyCut(const WeightedGraph &graph, const vector<int> *initialPartition = nullptr)
     {
-        _adjacencyList.reserve(_numberOfVertices);
-        _nodeList.reserve(_numberOfVertices);
+        int numberOfVertices = graph.numberOfVertices();
+        vector<int> cutPartition(numberOfVertices, 0);
+        vector<int> usedNodes(numberOfVertices, 0);
+        if (numberOfVertices < 2)
+            return cutPartition;
+
+        // Order the vertices by their weight, heaviest first
+        vector<int> nodeList = orderByWeightedDegree(graph, true);
+
+        // Initialize the first two nodes, or all of them from the initial partition
+        int firstVertex = 2;
+        if (initialPartition)
+        {
+            for (int vertex = 0; vertex < numberOfVertices; ++vertex)
+            {
+                usedNodes[vertex] = (*initialPartition)[vertex] >= 0;
+                cutPartition[vertex] = usedNodes[vertex] ? (*initialPartition)[vertex] : 0;
+            }
+            firstVertex = 0;
+        }
+        else
+        {
+            cutPartition[nodeList[1]] = 1;
+            usedNodes[nodeList[0]] = 1;
+            usedNodes[nodeList[1]] = 1;
+        }
+
+        // Compute the maximum cut
+        for (int vertex = firstVertex; vertex < numberOfVertices; ++vertex)
+        {
+            int nodeID = nodeList[vertex];
+            long long connection0 = 0;
+            long long connection1 = 0;
+
+            for (int64_t arc = graph.firstArc(nodeID); arc < graph.lastArc(nodeID); ++arc)
+            {
+                int destination = graph.target(arc);
+                if (cutPartition[destination])
+                    connection1 += usedNodes[destination] * graph.weight(arc);
+                else
+                    connection0 += usedNodes[destination] * graph.weight(arc);
+            }
+
+            cutPartition[nodeID] = (connection1 < connection0) ? 1 : 0;
+            usedNodes[nodeID] = 1;
+        }
+
+        return cutPartition;
     }
 
     /**
-     * @brief Function to add an edge to the graph
-     * @param source Source vertex of the edge
-     * @param destination Destination vertex of the edge
-     * @param weight Weight of the edge
+     * @brief Flips vertices with a positive gain until none is left
+     *
+     * The gain of a vertex is the weight to its own side minus the weight to the other side. The vertices
+     * with a positive gain are kept in a bucket queue and the best one is flipped first, updating the
+     * gains of its neighbors in O(degree). Every flip strictly increases the cut.
+     *
+     * @param graph The graph, a CSRGraph or a CoarseLevel
+     * @param partition The side of every vertex, improved in place
+     * @return The increase of the weighted cut
      */
-    void addEdge(int source, int destination, int weight)
+    template <typename WeightedGraph>
+    static long long refineCut(const WeightedGraph &graph, vector<int> &partition)
     {
-        _adjacencyList[source - 1].emplace_back(destination - 1, weight);
+        int numberOfVertices = graph.numberOfVertices();
+        vector<long long> gains(numberOfVertices, 0);
+        vector<long long> maxGains(numberOfThreads(), 1);
+
+        parallelFor(0, numberOfVertices, [&](int threadID, int64_t first, int64_t last)
+                    {
+                        for (int64_t vertex = first; vertex < last; ++vertex)
+                        {
+                            long long gain = 0, absoluteDegree = 0;
+                            for (int64_t arc = graph.firstArc(vertex); arc < graph.lastArc(vertex); ++arc)
+                            {
+                                int destination = graph.target(arc);
+                                if (destination == vertex)
+                                    continue;
+                                gain += partition[destination] == partition[vertex] ? graph.weight(arc) : -graph.weight(arc);
+                                absoluteDegree += llabs(graph.weight(arc));
+                            }
+                            gains[vertex] = gain;
+                            maxGains[threadID] = max(maxGains[threadID], absoluteDegree);
+                        }
+                    });
+
+        BucketQueue queue(numberOfVertices, 1, *max_element(maxGains.begin(), maxGains.end()));
+        for (int vertex = 0; vertex < numberOfVertices; ++vertex)
+            if (gains[vertex] > 0)
+                queue.push(vertex, gains[vertex]);
+
+        long long improvement = 0;
+        while (!queue.empty())
+        {
+            int vertex = queue.pop();
+            improvement += gains[vertex];
+            partition[vertex] ^= 1;
+            gains[vertex] = -gains[vertex];
+            AE_COUNT("refinement flips", 1);
+
+            for (int64_t arc = graph.firstArc(vertex); arc < graph.lastArc(vertex); ++arc)
+            {
+                int destination = graph.target(arc);
+                if (destination == vertex)
+                    continue;
+
+                // The edge turned from cut to uncut or the other way round
+                long long change = 2 * static_cast<long long>(graph.weight(arc));
+                gains[destination] += partition[destination] == partition[vertex] ? change : -change;
+                if (gains[destination] > 0)
+                {
+                    if (queue.contains(destination))
+                        queue.update(destination, gains[destination]);
+                    else
+                        queue.push(destination, gains[destination]);
+                }
+                else if (queue.contains(destination))
+                    queue.remove(destination);
+            }
+        }
+
+        return improvement;
     }
 
     /**
-     * @brief Function to add a node to the graph
-     * @param id ID of the node
-     * @param degree Degree of the node
-     * @param weight Weight of the node
+     * @brief Computes the smallest eigenpair of a small symmetric tridiagonal matrix with cyclic Jacobi rotations
+     * @param alpha The diagonal entries
+     * @param beta The off-diagonal entries, beta[j] joins rows j and j + 1
+     * @param eigenvector Receives the eigenvector of the smallest eigenvalue, normalized to length 1
+     * @param spectralRadius Receives the largest absolute eigenvalue
+     * @return The smallest eigenvalue
      */
-    void addNode(int id, int degree, int weight)
+    static double smallestTridiagonalEigenpair(const vector<double> &alpha, const vector<double> &beta, vector<double> &eigenvector, double &spectralRadius)
+    {
+        int size = static_cast<int>(alpha.size());
+        vector<vector<double> > matrix(size, vector<double>(size, 0)), rotations(size, vector<double>(size, 0));
+        for (int row = 0; row < size; ++row)
+        {
+            matrix[row][row] = alpha[row];
+            rotations[row][row] = 1;
+            if (row + 1 < size)
+                matrix[row][row + 1] = matrix[row + 1][row] = beta[row];
+        }
+
+        for (int sweep = 0; sweep < 64; ++sweep)
+        {
+            double offDiagonal = 0, total = 0;
+            for (int row = 0; row < size; ++row)
+                for (int column = 0; column < size; ++column)
+                {
+                    total += matrix[row][column] * matrix[row][column];
+                    if (row != column)
+                        offDiagonal += matrix[row][column] * matrix[row][column];
+                }
+            if (offDiagonal <= 1e-28 * total)
+                break;
+
+            // Rotate every off-diagonal entry to zero in turn, later rotations only partly refill it
+            for (int p = 0; p < size; ++p)
+                for (int q = p + 1; q < size; ++q)
+                {
+                    if (matrix[p][q] == 0)
+                        continue;
+
+                    double theta = (matrix[q][q] - matrix[p][p]) / (2 * matrix[p][q]);
+                    double t = (theta >= 0 ? 1 : -1) / (abs(theta) + sqrt(theta * theta + 1));
+                    double c = 1 / sqrt(t * t + 1), s = t * c;
+                    for (int row = 0; row < size; ++row)
+                    {
+                        double atP = matrix[row][p], atQ = matrix[row][q];
+                        matrix[row][p] = c * atP - s * atQ;
+                        matrix[row][q] = s * atP + c * atQ;
+                    }
+                    for (int column = 0; column < size; ++column)
+                    {
+                        double atP = matrix[p][column], atQ = matrix[q][column];
+                        matrix[p][column] = c * atP - s * atQ;
+                        matrix[q][column] = s * atP + c * atQ;
+                    }
+                    for (int row = 0; row < size; ++row)
+                    {
+                        double atP = rotations[row][p], atQ = rotations[row][q];
+                        rotations[row][p] = c * atP - s * atQ;
+                        rotations[row][q] = s * atP + c * atQ;
+                    }
+                }
+        }
+
+        int smallest = 0;
+        spectralRadius = 0;
+        for (int index = 0; index < size; ++index)
+        {
+            if (matrix[index][index] < matrix[smallest][smallest])
+                smallest = index;
+            spectralRadius = max(spectralRadius, abs(matrix[index][index]));
+        }
+
+        eigenvector.resize(size);
+        for (int row = 0; row < size; ++row)
+            eigenvector[row] = rotations[row][smallest];
+        return matrix[smallest][smallest];
+    }
+
+    /**
+     * @brief Prints the weighted edge cut and the vertices on side 0
+     * @param cutPartition Vector representing the partition of the graph
+     */
+    void printCut(const vector<int> &cutPartition)
+    {
+        AE_PHASE("output");
+        ResultWriter out;
+        out << getWeightedEdgeCut(cutPartition) << '\n';
+
+        // Print the nodes in the cut
+        for (int i = 0; i < _numberOfVertices; ++i)
+        {
+            if (!cutPartition[i])
+            {
+                out << i + 1 << ' ';
+            }
+        }
+    }
+
+public:
+    // Constructor
+    Graph(CSRGraph graph) : _numberOfVertices(graph.numberOfVertices()), _graph(move(graph))
     {
-        _nodeList[id] = Node(id, degree, weight);
     }
 
     /**
@@ -98,13 +519,13 @@ public:
      * @param partition Vector representing the partition of the graph
      * @return Weighted edge cut of the partition
      */
-    int getWeightedEdgeCut(const vector<int> &partition)
+    long long getWeightedEdgeCut(const vector<int> &partition)
     {
-        int weightedEdgeCut = 0;
+        long long weightedEdgeCut = 0;
         for (int vertex = 0; vertex < _numberOfVertices; ++vertex)
-            for (const Edge &edge : _adjacencyList[vertex])
-                if (partition[vertex] != partition[edge.destination])
-                    weightedEdgeCut += edge.weight;
+            for (int64_t arc = _graph.firstArc(vertex); arc < _graph.lastArc(vertex); ++arc)
+                if (partition[vertex] != partition[_graph.target(arc)])
+                    weightedEdgeCut += _graph.weight(arc);
 
         return weightedEdgeCut / 2;
     }
@@ -114,56 +535,282 @@ public:
      */
     void computeMaxCut()
     {
-        vector<int> cutPartition(_numberOfVertices, 0);
-        vector<int> usedNodes(_numberOfVertices, 0);
+        vector<int> cutPartition;
+        {
+            AE_PHASE("algorithm");
+            cutPartition = greedyCut(_graph);
+        }
 
-        // Initialize the nodes with their weights
-        for (int vertex = 0; vertex < _numberOfVertices; ++vertex)
+        // Print the weighted edge cut
+        printCut(cutPartition);
+    }
+
+    /**
+     * @brief Approximates the eigenvector of the smallest eigenvalue of the weighted adjacency matrix
+     *
+     * Restarted Lanczos iteration on A itself. Every cycle runs up to 32 Lanczos steps from the current
+     * vector, takes the Ritz pair of the smallest eigenvalue of the small tridiagonal matrix and restarts
+     * from its Ritz vector. The Lanczos vectors are not stored but regenerated from the recorded
+     * coefficients to form the Ritz vector, so a cycle of k steps costs 2k - 1 products and the memory
+     * stays at five vectors. Unlike power iteration on a shifted matrix, the convergence depends on the
+     * gap to the next eigenvalue relative to the width of the spectrum, not to a Gershgorin bound.
+     *
+     * @param iterations The maximum number of products
+     * @param tolerance Stop once the residual |A x - lambda x| is below this fraction of the largest
+     *                  Ritz value magnitude, 0 to spend all products
+     * @param seed The seed for the random start vector
+     * @param eigenvalue Receives the estimate of the smallest eigenvalue of A
+     * @return The approximate eigenvector, normalized to length 1
+     */
+    vector<double> computeSmallestEigenvector(int iterations, double tolerance, unsigned long long seed, double &eigenvalue)
+    {
+        AE_PHASE("lanczos");
+        const int maxSteps = 32;
+        int n = _numberOfVertices;
+
+        // Random start vector, which has a component along the wanted eigenvector with probability 1
+        mt19937_64 generator(seed);
+        uniform_real_distribution<double> distribution(-1.0, 1.0);
+        vector<double> x(n), ritz(n), current(n), previous(n), next(n);
+        for (double &entry : x)
+            entry = distribution(generator);
+
+        vector<double> partial(numberOfThreads());
+        auto scaleToUnitLength = [&](vector<double> &values)
         {
-            int weight = 0;
-            for (const Edge &edge : _adjacencyList[vertex])
-                weight += edge.weight;
+            fill(partial.begin(), partial.end(), 0.0);
+            parallelFor(0, n, [&](int threadID, int64_t first, int64_t last)
+                        {
+                            for (int64_t vertex = first; vertex < last; ++vertex)
+                                partial[threadID] += values[vertex] * values[vertex];
+                        });
+            double norm = sqrt(accumulate(partial.begin(), partial.end(), 0.0));
+            if (norm > 0)
+                for (double &entry : values)
+                    entry /= norm;
+            return norm;
+        };
 
-            addNode(vertex, _adjacencyList[vertex].size(), weight);
-        }
+        // One Lanczos step: next = (A current - alpha current - betaBefore previous) / betaAfter. With a
+        // known alpha (regeneration) the product is only combined, otherwise alpha is computed first.
+        auto lanczosStep = [&](double betaBefore, double &alpha, bool knownAlpha)
+        {
+            sparseMatrixVectorProduct(_graph, current.data(), next.data());
+            AE_COUNT("spmv", 1);
+            if (!knownAlpha)
+            {
+                fill(partial.begin(), partial.end(), 0.0);
+                parallelFor(0, n, [&](int threadID, int64_t first, int64_t last)
+                            {
+                                for (int64_t vertex = first; vertex < last; ++vertex)
+                                    partial[threadID] += current[vertex] * next[vertex];
+                            });
+                alpha = accumulate(partial.begin(), partial.end(), 0.0);
+            }
 
-        // Sort the vertices based on their weight
-        sort(_nodeList.begin(), _nodeList.end(), [](const Node &a, const Node &b)
-             { return a.weight > b.weight; });
+            fill(partial.begin(), partial.end(), 0.0);
+            parallelFor(0, n, [&](int threadID, int64_t first, int64_t last)
+                        {
+                            for (int64_t vertex = first; vertex < last; ++vertex)
+                            {
+                                next[vertex] -= alpha * current[vertex] + betaBefore * previous[vertex];
+                                partial[threadID] += next[vertex] * next[vertex];
+                            }
+                        });
+            return sqrt(accumulate(partial.begin(), partial.end(), 0.0));
+        };
 
-        // Initialize the first two nodes
-        cutPartition[_nodeList[1].id] = 1;
-        usedNodes[_nodeList[0].id] = 1;
-        usedNodes[_nodeList[1].id] = 1;
+        eigenvalue = 0;
+        if (n == 0 || scaleToUnitLength(x) == 0)
+            return x;
 
-        // Compute the maximum cut
-        for (int vertex = 2; vertex < _numberOfVertices; ++vertex)
+        int products = 0;
+        while (products < iterations)
         {
-            int nodeID = _nodeList[vertex].id;
-            int connection0 = 0;
-            int connection1 = 0;
+            // Lanczos cycle from x, recording the coefficients of the tridiagonal matrix
+            int steps = max(1, min(maxSteps, (iterations - products + 1) / 2));
+            vector<double> alpha, beta;
+            double betaAfter = 0;
+            current = x;
+            fill(previous.begin(), previous.end(), 0.0);
+            for (int step = 0; step < steps; ++step)
+            {
+                double stepAlpha;
+                betaAfter = lanczosStep(step > 0 ? beta.back() : 0, stepAlpha, false);
+                alpha.push_back(stepAlpha);
+                ++products;
 
-            for (const Edge &edge : _adjacencyList[nodeID])
-                if (cutPartition[edge.destination])
-                    connection1 += usedNodes[edge.destination] * edge.weight;
-                else
-                    connection0 += usedNodes[edge.destination] * edge.weight;
+                // A tiny beta means x lies in an invariant subspace, its Ritz values are exact
+                if (step + 1 == steps || betaAfter <= 1e-12 * abs(stepAlpha))
+                    break;
 
-            cutPartition[nodeID] = (connection1 < connection0) ? 1 : 0;
-            usedNodes[nodeID] = 1;
+                beta.push_back(betaAfter);
+                previous.swap(current);
+                current.swap(next);
+                for (double &entry : current)
+                    entry /= betaAfter;
+            }
+            steps = static_cast<int>(alpha.size());
+
+            vector<double> coefficients;
+            double spectralRadius;
+            eigenvalue = smallestTridiagonalEigenpair(alpha, beta, coefficients, spectralRadius);
+
+            // Regenerate the Lanczos vectors and sum up the Ritz vector
+            fill(ritz.begin(), ritz.end(), 0.0);
+            current = x;
+            fill(previous.begin(), previous.end(), 0.0);
+            for (int step = 0; step < steps; ++step)
+            {
+                for (int vertex = 0; vertex < n; ++vertex)
+                    ritz[vertex] += coefficients[step] * current[vertex];
+                if (step + 1 == steps)
+                    break;
+
+                lanczosStep(step > 0 ? beta[step - 1] : 0, alpha[step], true);
+                ++products;
+                previous.swap(current);
+                current.swap(next);
+                for (double &entry : current)
+                    entry /= beta[step];
+            }
+
+            x.swap(ritz);
+            scaleToUnitLength(x);
+
+            // The residual of the Ritz pair is the last beta times the last coefficient
+            if (abs(betaAfter * coefficients[steps - 1]) <= tolerance * spectralRadius)
+                break;
+        }
+
+        return x;
+    }
+
+    /**
+     * @brief Function to compute the maximum cut of the graph from a spectral initial cut
+     *
+     * The signs of the approximate eigenvector of the smallest eigenvalue of the adjacency matrix tend to
+     * put heavily connected vertices on opposite sides. On graphs with hubs the eigenvector is localized
+     * and only its large entries carry information, so it is rounded with a sweep: the vertices with the
+     * largest entries take the side of their sign, a greedy pass in weighted-degree order places the
+     * others and may move them. This is tried for several fractions of seeded vertices, including none,
+     * and the best cut is refined with positive-gain flips.
+     *
+     * @param iterations The maximum number of matrix-vector products
+     * @param seed The seed for the random start vector
+     */
+    void computeSpectralMaxCut(int iterations, unsigned long long seed)
+    {
+        vector<int> cutPartition;
+        {
+            AE_PHASE("algorithm");
+            double eigenvalue;
+            vector<double> eigenvector = computeSmallestEigenvector(iterations, 1e-4, seed, eigenvalue);
+
+            {
+                AE_PHASE("rounding");
+                vector<int> order(_numberOfVertices);
+                iota(order.begin(), order.end(), 0);
+                sort(order.begin(), order.end(), [&eigenvector](int first, int second)
+                     { return abs(eigenvector[first]) > abs(eigenvector[second]); });
+
+                vector<int> seeded(_numberOfVertices, -1);
+                int numberOfSeeded = 0;
+                long long bestCut = -1;
+                for (double fraction : {0.0, 0.01, 0.05, 0.2, 1.0})
+                {
+                    for (; numberOfSeeded < fraction * _numberOfVertices; ++numberOfSeeded)
+                        seeded[order[numberOfSeeded]] = eigenvector[order[numberOfSeeded]] < 0;
+
+                    vector<int> candidate = greedyCut(_graph, &seeded);
+                    long long cut = getWeightedEdgeCut(candidate);
+                    if (cut > bestCut)
+                    {
+                        bestCut = cut;
+                        cutPartition = move(candidate);
+                    }
+                }
+            }
+
+            {
+                AE_PHASE("refinement");
+                refineCut(_graph, cutPartition);
+            }
         }
 
         // Print the weighted edge cut
-        cout << getWeightedEdgeCut(cutPartition) << endl;
+        printCut(cutPartition);
+    }
 
-        // Print the nodes in the cut
-        for (int i = 0; i < _numberOfVertices; ++i)
+    /**
+     * @brief Function to compute the maximum cut of the graph with a multilevel scheme
+     *
+     * The graph is coarsened by heavy-edge matching until at most coarsestSize vertices are left or a
+     * level shrinks by less than 5%. The coarsest graph is cut greedily, then the cut is projected back
+     * level by level and refined with positive-gain flips on each one. Every level takes O(n + m) time
+     * and memory and is released as soon as the cut has been projected to the finer level.
+     *
+     * @param coarsestSize The number of vertices at which the coarsening stops
+     * @param seed The seed for the matching order
+     */
+    void computeMultilevelMaxCut(int coarsestSize, unsigned long long seed)
+    {
+        vector<int> cutPartition;
         {
-            if (!cutPartition[i])
+            AE_PHASE("algorithm");
+            mt19937_64 generator(seed);
+            vector<CoarseLevel> levels;
+            {
+                AE_PHASE("coarsening");
+                int vertices = _numberOfVertices;
+                while (vertices > coarsestSize)
+                {
+                    CoarseLevel level = levels.empty() ? CoarseLevel(_graph, generator) : CoarseLevel(levels.back(), generator);
+                    if (level.numberOfVertices() > 0.95 * vertices)
+                        break;
+
+                    vertices = level.numberOfVertices();
+                    levels.push_back(move(level));
+                    AE_COUNT("levels", 1);
+                }
+            }
+
             {
-                cout << i + 1 << " ";
+                AE_PHASE("initial cut");
+                if (levels.empty())
+                    cutPartition = greedyCut(_graph);
+                else
+                {
+                    cutPartition = greedyCut(levels.back());
+                    refineCut(levels.back(), cutPartition);
+                }
+            }
+
+            {
+                AE_PHASE("uncoarsening");
+                while (!levels.empty())
+                {
+                    // Project the cut to the next finer level and drop the coarse one
+                    int fineVertices = levels.size() > 1 ? levels[levels.size() - 2].numberOfVertices() : _numberOfVertices;
+                    vector<int> finePartition(fineVertices);
+                    parallelFor(0, fineVertices, [&](int, int64_t first, int64_t last)
+                                {
+                                    for (int64_t vertex = first; vertex < last; ++vertex)
+                                        finePartition[vertex] = levels.back().project(static_cast<int>(vertex), cutPartition);
+                                });
+                    cutPartition.swap(finePartition);
+                    levels.pop_back();
+
+                    if (levels.empty())
+                        refineCut(_graph, cutPartition);
+                    else
+                        refineCut(levels.back(), cutPartition);
+                }
             }
         }
+
+        // Print the weighted edge cut
+        printCut(cutPartition);
     }
 };
 
@@ -171,24 +818,88 @@ public:
  * @brief Main function
  * @return 0 on successful execution
  */
-int main()
+int main(int argc, char *argv[])
 {
     ios_base::sync_with_stdio(false);
     cin.tie(NULL);
 
+    // Read from the file given as first argument, or from standard input
+    GraphReader file(argc > 1 ? argv[1] : nullptr);
+    if (!file.isOpen())
+    {
+        cerr << "Failed to open the file." << endl;
+        return 1;
+    }
+
     // Read the number of nodes and edges
     int numberOfNodes, numberOfEdges;
-    cin >> numberOfNodes >> numberOfEdges;
+    file >> numberOfNodes >> numberOfEdges;
+
+    // Read the edges and create a graph with the read number of nodes
+    Graph G(file.readGraph(numberOfNodes, 2 * static_cast<int64_t>(numberOfEdges)));
+    if (!file)
+    {
+        cerr << "Invalid graph input." << endl;
+        return 1;
+    }
+
+    // "ex3 <file|-> --multilevel [--coarsest N] [--seed S]" runs the multilevel solver instead of the greedy cut
+    if (argc > 2 && string(argv[2]) == "--multilevel")
+    {
+        int coarsestSize = 1000;
+        unsigned long long seed = random_device()();
+        for (int i = 3; i + 1 < argc; i += 2)
+        {
+            string option = argv[i];
+            if (option == "--coarsest")
+                coarsestSize = max(2, atoi(argv[i + 1]));
+            else if (option == "--seed")
+                seed = strtoull(argv[i + 1], nullptr, 10);
+            else
+            {
+                cerr << "Unknown option " << option << "." << endl;
+                return 1;
+            }
+        }
 
-    // Create a graph
-    Graph G(numberOfNodes);
+        G.computeMultilevelMaxCut(coarsestSize, seed);
+        return 0;
+    }
 
-    // Add edges to the graph
-    for (int i = 0; i < numberOfEdges * 2; ++i)
+    // "ex3 <file|-> --spectral [--iterations K] [--seed S]" seeds the greedy cut with the signs of an eigenvector,
+    // "ex3 <file|-> --spmv [--iterations K] [--seed S]" only runs K Lanczos products and prints the eigenvalue
+    if (argc > 2 && (string(argv[2]) == "--spectral" || string(argv[2]) == "--spmv"))
     {
-        int source, destination, weight;
-        cin >> source >> destination >> weight;
-        G.addEdge(source, destination, weight);
+        int iterations = 300;
+        unsigned long long seed = random_device()();
+        for (int i = 3; i + 1 < argc; i += 2)
+        {
+            string option = argv[i];
+            if (option == "--iterations")
+                iterations = max(1, atoi(argv[i + 1]));
+            else if (option == "--seed")
+                seed = strtoull(argv[i + 1], nullptr, 10);
+            else
+            {
+                cerr << "Unknown option " << option << "." << endl;
+                return 1;
+            }
+        }
+
+        if (string(argv[2]) == "--spectral")
+        {
+            G.computeSpectralMaxCut(iterations, seed);
+            return 0;
+        }
+
+        double eigenvalue;
+        {
+            AE_PHASE("algorithm");
+            G.computeSmallestEigenvector(iterations, 0, seed, eigenvalue);
+        }
+        ResultWriter out;
+        out << eigenvalue << '\n';
+        return 0;
     }
 
     // Compute the maximum cut
@@ -1,54 +1,1047 @@
 #include <cmath>
+#include <chrono>
+#include <cstdint>
 #include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
 #include <vector>
 #include <iostream>
 #include <algorithm>
-#include <fstream>
+#include <atomic>
 #include <unordered_map>
 #include <queue>
+#include <string>
 
-using namespace std;
-
-/**
- * @struct Edge
- * @brief Structure to represent an edge in the graph
- * @var Edge::destination
- * Member 'destination' represents the destination vertex of the edge
- * @var Edge::weight
- * Member 'weight' represents the weight of the edge
- */
-struct Edge
-{
-    int destination; // Destination vertex of the edge
-    int weight;      // Weight of the edge
+#include "cpu_features.h"
+#include "csr_graph.h"
+#include "graph_reader.h"
+#include "instrumentation.h"
+#include "parallel.h"
+#include "result_writer.h"
 
-    Edge(int dest, int w) : destination(dest), weight(w) {}
-};
+using namespace std;
 
 /**
  * @struct Node
  * @brief Structure to represent a node in the graph
  * @var Node::id
  * Member 'id' represents the ID of the node
- * @var Node::degree
- * Member 'degree' represents the degree of the node (number of edges)
  * @var Node::weight
  * Member 'weight' represents the weight of the node
  */
 struct Node
 {
-    int id;       // ID of the node
-    int weight;   // Weight of the node
-    float cost;   // Cost of the node
-    bool blocked; // Marker if node is blocked
-    bool chosen;  // Marker if node is chosen
+    int id;     // ID of the node
+    int weight; // Weight of the node
+
+    Node(int i, int weight) : id(i), weight(weight) {}
+};
+
+/**
+ * @class Reducer
+ * @brief Shrinks a maximum weight independent set instance with exact reduction rules.
+ *
+ * The rules are applied until none of them matches any vertex:
+ *  - isolated vertices and vertices at least as heavy as their whole neighborhood are taken,
+ *  - a degree-1 vertex lighter than its neighbor is folded into the neighbor,
+ *  - a degree-2 vertex with non-adjacent neighbors at most as heavy as itself, but lighter than both
+ *    together, is folded with them into one vertex of weight w(u1) + w(u2) - w(v),
+ *  - a simplicial vertex (its neighbors form a clique) at least as heavy as every neighbor is taken,
+ *  - a neighbor u of v with N[v] contained in N[u] and w(u) <= w(v) is removed (domination).
+ * Every rule keeps an optimal solution of the reduced graph optimal for the original one, and folds
+ * are recorded so a solution of the kernel can be lifted back.
+ *
+ * The graph is kept as one adjacency list per vertex in which removed vertices are dropped lazily the
+ * next time the list is read, together with the live degree and neighborhood weight of every vertex.
+ * A vertex goes back on the worklist whenever its neighborhood changes, so every rule application
+ * costs O(degree) apart from the clique and domination tests, which are limited to small degrees.
+ * Lists of vertices above that degree are only read when the vertex is taken or folded.
+ *
+ * A degree-1 fold lowers the weight of the neighbor, which would have to be subtracted from the
+ * neighborhood weight of all of its neighbors. Instead the decrease is only recorded at the neighbor
+ * and handed on once the worklist runs empty, so folding all leaves of a hub costs O(1) per leaf plus
+ * one pass over the hub. Until then the neighborhood weights may be too large, which only delays the
+ * neighborhood removal rule.
+ */
+class Reducer
+{
+private:
+    /**
+     * @struct Fold
+     * @brief A folded vertex with the neighbors it was merged with, u2 is -1 for degree-1 folds
+     */
+    struct Fold
+    {
+        int vertex; // Degree-1: the removed vertex. Degree-2: the center, whose ID the merged vertex reuses
+        int u1;     // The neighbor that absorbed the vertex, or the first merged neighbor
+        int u2;     // The second merged neighbor, -1 for degree-1 folds
+    };
+
+    static const int _maxTestDegree = 64; // Largest degree for the clique and domination tests
 
-    Node(int i, int weight, float cost, bool blocked, bool chosen) : id(i), weight(weight), cost(cost), blocked(blocked), chosen(chosen) {}
+    int _numberOfVertices;               // Number of vertices of the input graph
+    vector<vector<int> > _adjacency;     // Neighbors of every vertex, may contain removed vertices
+    vector<long long> _weights;          // Current weight of every vertex
+    vector<int> _degrees;                // Number of live neighbors of every vertex
+    vector<long long> _neighborWeights;  // Total weight of the live neighbors of every vertex, before pending decreases
+    vector<long long> _pendingDecreases; // Weight decrease of every vertex not yet handed on to its neighbors
+    vector<int> _decreased;              // Vertices with a pending decrease
+    vector<char> _alive;                 // Whether a vertex is still in the graph
+    vector<char> _inSet;                 // Whether a vertex was taken into the solution
+    vector<Fold> _folds;                 // Folds in the order they were applied
+    vector<int> _worklist;               // Vertices whose neighborhood changed
+    vector<char> _queued;                // Whether a vertex is on the worklist
+    vector<int> _marks;                  // Stamp of the last test that marked a vertex
+    int _stamp = 0;                      // Current stamp
 
-    // Overload the '<' operator to compare nodes based on their weight
-    bool operator<(const Node &other) const
+    void _push(int vertex)
     {
-        return cost > other.cost;
+        if (_alive[vertex] && !_queued[vertex])
+        {
+            _queued[vertex] = 1;
+            _worklist.push_back(vertex);
+        }
+    }
+
+    // Drops removed vertices from the adjacency list of a vertex and returns it
+    const vector<int> &_neighbors(int vertex)
+    {
+        vector<int> &neighbors = _adjacency[vertex];
+        if (static_cast<int>(neighbors.size()) != _degrees[vertex])
+            neighbors.erase(remove_if(neighbors.begin(), neighbors.end(), [this](int neighbor)
+                                      { return !_alive[neighbor]; }),
+                            neighbors.end());
+        return neighbors;
+    }
+
+    // Removes a vertex from the graph and queues its neighbors
+    void _remove(int vertex)
+    {
+        _alive[vertex] = 0;
+        for (int neighbor : _adjacency[vertex])
+        {
+            if (!_alive[neighbor])
+                continue;
+            _degrees[neighbor] -= 1;
+            _neighborWeights[neighbor] -= _weights[vertex] + _pendingDecreases[vertex];
+            _push(neighbor);
+        }
+        _pendingDecreases[vertex] = 0;
+    }
+
+    // Subtracts the pending weight decreases from the neighborhood weights and queues the neighbors
+    void _applyDecreases()
+    {
+        for (int vertex : _decreased)
+        {
+            if (_alive[vertex] && _pendingDecreases[vertex] > 0)
+                for (int neighbor : _neighbors(vertex))
+                {
+                    _neighborWeights[neighbor] -= _pendingDecreases[vertex];
+                    _push(neighbor);
+                }
+            _pendingDecreases[vertex] = 0;
+        }
+        _decreased.clear();
+    }
+
+    // Takes a vertex into the solution and removes its neighborhood
+    void _include(int vertex)
+    {
+        _inSet[vertex] = 1;
+        const vector<int> &neighbors = _neighbors(vertex);
+        _remove(vertex);
+        for (int neighbor : neighbors)
+            if (_alive[neighbor])
+                _remove(neighbor);
+        AE_COUNT("reduced vertices", 1 + static_cast<long long>(neighbors.size()));
+    }
+
+    // Whether two vertices are adjacent, scans the shorter list
+    bool _adjacent(int a, int b)
+    {
+        if (_degrees[a] > _degrees[b])
+            swap(a, b);
+        const vector<int> &neighbors = _neighbors(a);
+        return find(neighbors.begin(), neighbors.end(), b) != neighbors.end();
+    }
+
+    // Merges a degree-2 vertex with its two non-adjacent neighbors into one vertex with the ID of the center
+    void _foldDegreeTwo(int vertex, int u1, int u2)
+    {
+        long long weight = _weights[u1] + _weights[u2] - _weights[vertex];
+
+        // Union of both neighborhoods without the center
+        ++_stamp;
+        _marks[vertex] = _stamp;
+        vector<int> merged;
+        for (int u : {u1, u2})
+            for (int neighbor : _neighbors(u))
+                if (_marks[neighbor] != _stamp)
+                {
+                    _marks[neighbor] = _stamp;
+                    merged.push_back(neighbor);
+                }
+
+        _remove(u1);
+        _remove(u2);
+        _weights[vertex] = weight;
+        _pendingDecreases[vertex] = 0;
+        _degrees[vertex] = static_cast<int>(merged.size());
+        _neighborWeights[vertex] = 0;
+        for (int neighbor : merged)
+        {
+            _adjacency[neighbor].push_back(vertex);
+            _degrees[neighbor] += 1;
+            _neighborWeights[neighbor] += weight;
+            _neighborWeights[vertex] += _weights[neighbor] + _pendingDecreases[neighbor];
+            _push(neighbor);
+        }
+        _adjacency[vertex] = move(merged);
+        _folds.push_back(Fold{vertex, u1, u2});
+        _push(vertex);
+        AE_COUNT("reduced vertices", 2);
+    }
+
+    // Applies the first rule that matches a vertex, returns whether one did
+    bool _reduceVertex(int vertex)
+    {
+        // Isolated vertices and neighborhood removal
+        if (_weights[vertex] >= _neighborWeights[vertex])
+        {
+            _include(vertex);
+            return true;
+        }
+
+        if (_degrees[vertex] == 1)
+        {
+            // The neighborhood weight may be too large, compare with the neighbor itself
+            int neighbor = _neighbors(vertex)[0];
+            if (_weights[vertex] >= _weights[neighbor])
+            {
+                _include(vertex);
+                return true;
+            }
+
+            // The vertex is lighter than its neighbor: taking the neighbor is worth w(u) - w(v) more
+            _weights[neighbor] -= _weights[vertex];
+            if (_weights[vertex] > 0)
+            {
+                if (_pendingDecreases[neighbor] == 0)
+                    _decreased.push_back(neighbor);
+                _pendingDecreases[neighbor] += _weights[vertex];
+            }
+            _remove(vertex);
+            _folds.push_back(Fold{vertex, neighbor, -1});
+            AE_COUNT("reduced vertices", 1);
+            return true;
+        }
+
+        if (_degrees[vertex] == 2)
+        {
+            const vector<int> &neighbors = _neighbors(vertex);
+            int u1 = neighbors[0], u2 = neighbors[1];
+            if (_weights[vertex] >= _weights[u1] + _weights[u2])
+            {
+                _include(vertex);
+                return true;
+            }
+            if (_weights[vertex] >= max(_weights[u1], _weights[u2]))
+            {
+                // A triangle is a simplicial vertex, otherwise fold
+                if (_adjacent(u1, u2))
+                    _include(vertex);
+                else
+                    _foldDegreeTwo(vertex, u1, u2);
+                return true;
+            }
+            return false;
+        }
+
+        if (_degrees[vertex] > _maxTestDegree)
+            return false;
+        const vector<int> &neighbors = _neighbors(vertex);
+
+        // Mark N[v] for the clique and domination tests
+        ++_stamp;
+        int stamp = _stamp;
+        _marks[vertex] = stamp;
+        long long maxNeighborWeight = 0;
+        for (int neighbor : neighbors)
+        {
+            _marks[neighbor] = stamp;
+            maxNeighborWeight = max(maxNeighborWeight, _weights[neighbor]);
+        }
+
+        // Simplicial vertex: every neighbor sees all other neighbors
+        bool clique = _weights[vertex] >= maxNeighborWeight;
+        for (size_t i = 0; i < neighbors.size() && clique; ++i)
+        {
+            int marked = 0;
+            for (int secondNeighbor : _neighbors(neighbors[i]))
+                marked += _marks[secondNeighbor] == stamp;
+            clique = marked == _degrees[vertex];
+        }
+        if (clique)
+        {
+            _include(vertex);
+            return true;
+        }
+
+        // Domination: a neighbor u with N[v] in N[u] and w(u) <= w(v) can be replaced by v in any solution
+        vector<int> dominated;
+        for (int neighbor : neighbors)
+        {
+            if (_weights[neighbor] > _weights[vertex] || _degrees[neighbor] < _degrees[vertex])
+                continue;
+            int marked = 0;
+            for (int secondNeighbor : _neighbors(neighbor))
+                marked += _marks[secondNeighbor] == stamp;
+            if (marked == _degrees[vertex])
+                dominated.push_back(neighbor);
+        }
+        for (int neighbor : dominated)
+            _remove(neighbor);
+        AE_COUNT("reduced vertices", static_cast<long long>(dominated.size()));
+        return !dominated.empty();
+    }
+
+public:
+    /**
+     * @brief Copies a graph into the dynamic representation, dropping self-loops and parallel edges
+     * @param graph The graph
+     * @param weights The weight of every vertex, non-negative
+     */
+    Reducer(const CSRGraph &graph, const vector<long long> &weights)
+        : _numberOfVertices(graph.numberOfVertices()), _adjacency(_numberOfVertices), _weights(weights),
+          _degrees(_numberOfVertices), _neighborWeights(_numberOfVertices, 0), _pendingDecreases(_numberOfVertices, 0),
+          _alive(_numberOfVertices, 1), _inSet(_numberOfVertices, 0), _queued(_numberOfVertices, 0), _marks(_numberOfVertices, 0)
+    {
+        for (int vertex = 0; vertex < _numberOfVertices; ++vertex)
+        {
+            vector<int> &neighbors = _adjacency[vertex];
+            for (int neighbor : graph.neighbors(vertex))
+                if (neighbor != vertex)
+                    neighbors.push_back(neighbor);
+            sort(neighbors.begin(), neighbors.end());
+            neighbors.erase(unique(neighbors.begin(), neighbors.end()), neighbors.end());
+
+            _degrees[vertex] = static_cast<int>(neighbors.size());
+            for (int neighbor : neighbors)
+                _neighborWeights[vertex] += _weights[neighbor];
+        }
+    }
+
+    /**
+     * @brief Applies the reduction rules exhaustively
+     */
+    void reduce()
+    {
+        AE_PHASE("reduce");
+        for (int vertex = _numberOfVertices - 1; vertex >= 0; --vertex)
+            _push(vertex);
+
+        while (!_worklist.empty())
+        {
+            int vertex = _worklist.back();
+            _worklist.pop_back();
+            _queued[vertex] = 0;
+            if (_alive[vertex])
+                _reduceVertex(vertex);
+
+            // The decreases may enable more neighborhood removals
+            if (_worklist.empty())
+                _applyDecreases();
+        }
+    }
+
+    /**
+     * @brief Builds the remaining graph with consecutive vertex IDs
+     * @param kernelVertices Receives the original ID of every kernel vertex
+     * @param kernelWeights Receives the weight of every kernel vertex
+     * @return The kernel
+     */
+    CSRGraph kernel(vector<int> &kernelVertices, vector<long long> &kernelWeights)
+    {
+        vector<int> kernelID(_numberOfVertices, -1);
+        kernelVertices.clear();
+        kernelWeights.clear();
+        for (int vertex = 0; vertex < _numberOfVertices; ++vertex)
+            if (_alive[vertex])
+            {
+                kernelID[vertex] = static_cast<int>(kernelVertices.size());
+                kernelVertices.push_back(vertex);
+                kernelWeights.push_back(_weights[vertex]);
+            }
+
+        vector<InputEdge> edges;
+        for (int vertex : kernelVertices)
+            for (int neighbor : _neighbors(vertex))
+                edges.push_back(InputEdge{kernelID[vertex], kernelID[neighbor], 1});
+        return CSRGraph(static_cast<int>(kernelVertices.size()), edges);
+    }
+
+    /**
+     * @brief Turns an independent set of the kernel into one of the input graph
+     * @param kernelSet The chosen kernel vertices, by original ID
+     * @return The chosen vertices of the input graph
+     */
+    vector<int> lift(const vector<int> &kernelSet)
+    {
+        vector<char> inSet = _inSet;
+        for (int vertex : kernelSet)
+            inSet[vertex] = 1;
+
+        // Undo the folds from the last to the first
+        for (auto fold = _folds.rbegin(); fold != _folds.rend(); ++fold)
+        {
+            if (fold->u2 == -1)
+                inSet[fold->vertex] = !inSet[fold->u1];
+            else if (inSet[fold->vertex])
+            {
+                inSet[fold->vertex] = 0;
+                inSet[fold->u1] = 1;
+                inSet[fold->u2] = 1;
+            }
+            else
+                inSet[fold->vertex] = 1;
+        }
+
+        vector<int> independentSet;
+        for (int vertex = 0; vertex < _numberOfVertices; ++vertex)
+            if (inSet[vertex])
+                independentSet.push_back(vertex);
+        return independentSet;
+    }
+};
+
+/**
+ * @class LocalSearch
+ * @brief Iterated local search for the maximum weight independent set in the style of ARW and ILS-VND.
+ *
+ * Every vertex knows its tightness, the number of solution vertices among its neighbors, and the
+ * total weight of those neighbors. Both change in O(degree) when a vertex enters or leaves the
+ * solution, so moves are evaluated in constant time instead of rescanning adjacency lists:
+ *  - (omega,1)-swap: a vertex outside the solution that is heavier than its solution neighbors
+ *    replaces them, which includes free vertices (tightness 0),
+ *  - (1,*)-swap: a solution vertex is replaced by a heavier independent set of its 1-tight neighbors,
+ *    the vertices whose only solution neighbor it is, found greedily by weight.
+ * After every local optimum the solution is perturbed by forcing a few random vertices in, which stay
+ * fixed for that iteration. A result worse than before the perturbation is undone from a log of the
+ * changes, except for an occasional accepted step downhill. The best solution seen is always kept.
+ */
+class LocalSearch
+{
+private:
+    const CSRGraph &_graph;             // The graph
+    const vector<long long> &_weights;  // Weight of every vertex
+    vector<char> _inSet;                // Whether a vertex is in the current solution
+    vector<int> _tightness;             // Number of solution neighbors of every vertex
+    vector<long long> _solutionWeights; // Total weight of the solution neighbors of every vertex
+    long long _weight = 0;              // Weight of the current solution
+    vector<pair<int, char> > _log;      // Insertions (1) and removals (0) since the last perturbation
+    vector<int> _worklist;              // Vertices whose neighborhood changed
+    vector<char> _queued;               // Whether a vertex is on the worklist
+    vector<int> _fixed;                 // Iteration in which a vertex was forced in
+    vector<int> _marks;                 // Stamp of the last (1,*)-swap that picked a vertex or its neighbor
+    int _stamp = 0;                     // Current stamp
+    int _iteration = 0;                 // Current iteration
+    mt19937_64 _generator;              // Random numbers for the perturbation
+
+    void _push(int vertex)
+    {
+        if (!_queued[vertex])
+        {
+            _queued[vertex] = 1;
+            _worklist.push_back(vertex);
+        }
+    }
+
+    void _insert(int vertex)
+    {
+        _inSet[vertex] = 1;
+        _weight += _weights[vertex];
+        _log.emplace_back(vertex, 1);
+        _push(vertex);
+        for (int neighbor : _graph.neighbors(vertex))
+        {
+            if (neighbor == vertex)
+                continue;
+            _tightness[neighbor] += 1;
+            _solutionWeights[neighbor] += _weights[vertex];
+            _push(neighbor);
+        }
+    }
+
+    void _remove(int vertex)
+    {
+        _inSet[vertex] = 0;
+        _weight -= _weights[vertex];
+        _log.emplace_back(vertex, 0);
+        _push(vertex);
+        for (int neighbor : _graph.neighbors(vertex))
+        {
+            if (neighbor == vertex)
+                continue;
+            _tightness[neighbor] -= 1;
+            _solutionWeights[neighbor] -= _weights[vertex];
+            _push(neighbor);
+        }
+    }
+
+    // Inserts a vertex and removes its solution neighbors
+    void _forceInsert(int vertex)
+    {
+        for (int neighbor : _graph.neighbors(vertex))
+            if (neighbor != vertex && _inSet[neighbor])
+                _remove(neighbor);
+        _insert(vertex);
+    }
+
+    // Whether a solution neighbor of a vertex was forced in during this iteration
+    bool _touchesFixed(int vertex)
+    {
+        for (int neighbor : _graph.neighbors(vertex))
+            if (neighbor != vertex && _inSet[neighbor] && _fixed[neighbor] == _iteration)
+                return true;
+        return false;
+    }
+
+    // Tries to replace a solution vertex by a heavier independent set of its 1-tight neighbors
+    bool _oneStarSwap(int vertex)
+    {
+        if (_fixed[vertex] == _iteration)
+            return false;
+
+        vector<int> candidates;
+        for (int neighbor : _graph.neighbors(vertex))
+            if (neighbor != vertex && !_inSet[neighbor] && _tightness[neighbor] == 1)
+                candidates.push_back(neighbor);
+        if (candidates.size() < 2)
+            return false;
+
+        sort(candidates.begin(), candidates.end(), [this](int a, int b)
+             { return _weights[a] > _weights[b] || (_weights[a] == _weights[b] && a < b); });
+
+        // Greedy independent set among the candidates, a candidate is blocked if a picked one is adjacent
+        ++_stamp;
+        vector<int> picked;
+        long long pickedWeight = 0;
+        for (int candidate : candidates)
+        {
+            if (_marks[candidate] == _stamp)
+                continue;
+            picked.push_back(candidate);
+            pickedWeight += _weights[candidate];
+            for (int neighbor : _graph.neighbors(candidate))
+                _marks[neighbor] = _stamp;
+        }
+        if (pickedWeight <= _weights[vertex])
+            return false;
+
+        _remove(vertex);
+        for (int candidate : picked)
+            _insert(candidate);
+        AE_COUNT("one star swaps", 1);
+        return true;
+    }
+
+    // Applies improving moves until the solution is a local optimum
+    void _localSearch()
+    {
+        while (!_worklist.empty())
+        {
+            int vertex = _worklist.back();
+            _worklist.pop_back();
+            _queued[vertex] = 0;
+
+            if (_inSet[vertex])
+                _oneStarSwap(vertex);
+            else if (_weights[vertex] > _solutionWeights[vertex])
+            {
+                if (!_touchesFixed(vertex))
+                {
+                    _forceInsert(vertex);
+                    AE_COUNT("omega swaps", 1);
+                }
+            }
+            else if (_tightness[vertex] == 1)
+            {
+                // The vertex may complete a (1,*)-swap of its only solution neighbor
+                for (int neighbor : _graph.neighbors(vertex))
+                    if (_inSet[neighbor])
+                    {
+                        _oneStarSwap(neighbor);
+                        break;
+                    }
+            }
+        }
+    }
+
+    // Undoes the changes since the last perturbation
+    void _undo()
+    {
+        vector<pair<int, char> > log;
+        log.swap(_log);
+        for (auto change = log.rbegin(); change != log.rend(); ++change)
+        {
+            if (change->second)
+                _remove(change->first);
+            else
+                _insert(change->first);
+        }
+        _log.clear();
+
+        // The worklist was empty before, so it holds exactly the vertices queued by the undo
+        for (int vertex : _worklist)
+            _queued[vertex] = 0;
+        _worklist.clear();
+    }
+
+public:
+    /**
+     * @brief Starts from an independent set
+     * @param graph The graph
+     * @param weights The weight of every vertex
+     * @param independentSet The initial solution
+     * @param seed The seed for the perturbation
+     */
+    LocalSearch(const CSRGraph &graph, const vector<long long> &weights, const vector<int> &independentSet, unsigned long long seed)
+        : _graph(graph), _weights(weights), _inSet(graph.numberOfVertices(), 0), _tightness(graph.numberOfVertices(), 0),
+          _solutionWeights(graph.numberOfVertices(), 0), _queued(graph.numberOfVertices(), 0), _fixed(graph.numberOfVertices(), -1),
+          _marks(graph.numberOfVertices(), 0), _generator(seed)
+    {
+        for (int vertex : independentSet)
+            _insert(vertex);
+        _log.clear();
+    }
+
+    /**
+     * @brief Improves the solution until the time budget is used up
+     * @param seconds The wall-clock budget
+     * @return The best independent set found
+     */
+    vector<int> run(double seconds)
+    {
+        AE_PHASE("local search");
+        chrono::steady_clock::time_point deadline = chrono::steady_clock::now() + chrono::duration_cast<chrono::steady_clock::duration>(chrono::duration<double>(seconds));
+        int n = _graph.numberOfVertices();
+
+        // Descend to a local optimum from the initial solution
+        for (int vertex = 0; vertex < n; ++vertex)
+            _push(vertex);
+        _localSearch();
+        _log.clear();
+
+        vector<char> best = _inSet;
+        long long bestWeight = _weight;
+        if (n == 0)
+            return {};
+
+        for (_iteration = 0; ; ++_iteration)
+        {
+            if ((_iteration & 63) == 0 && chrono::steady_clock::now() >= deadline)
+                break;
+            AE_COUNT("local search iterations", 1);
+
+            // Force in k random vertices, k = i + 1 with probability 1 / 2^(i + 1)
+            long long previousWeight = _weight;
+            int forced = 1;
+            while (forced < 4 && (_generator() & 1))
+                ++forced;
+            for (int i = 0; i < forced; ++i)
+            {
+                int vertex = static_cast<int>(_generator() % n);
+                if (_inSet[vertex] || _touchesFixed(vertex))
+                    continue;
+                _forceInsert(vertex);
+                _fixed[vertex] = _iteration;
+            }
+            _localSearch();
+
+            if (_weight > bestWeight)
+            {
+                best = _inSet;
+                bestWeight = _weight;
+            }
+            else if (_weight < previousWeight && _generator() % 16 != 0)
+                _undo();
+            _log.clear();
+        }
+
+        vector<int> independentSet;
+        for (int vertex = 0; vertex < n; ++vertex)
+            if (best[vertex])
+                independentSet.push_back(vertex);
+        return independentSet;
+    }
+};
+
+/**
+ * @brief Writes a & ~b for the words [first, last) of two bitsets to out
+ */
+inline void scalarAndNot(uint64_t *out, const uint64_t *a, const uint64_t *b, int first, int last)
+{
+    for (int word = first; word < last; ++word)
+        out[word] = a[word] & ~b[word];
+}
+
+#ifdef AE_X86_SIMD
+
+/**
+ * @brief Writes a & ~b for the words [first, last) of two bitsets to out, four words per step
+ */
+__attribute__((target("avx2"))) inline void avx2AndNot(uint64_t *out, const uint64_t *a, const uint64_t *b, int first, int last)
+{
+    int word = first;
+    for (; word + 4 <= last; word += 4)
+    {
+        __m256i left = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(a + word));
+        __m256i right = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b + word));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + word), _mm256_andnot_si256(right, left));
+    }
+    scalarAndNot(out, a, b, word, last);
+}
+
+#endif
+
+/**
+ * @class BranchAndBound
+ * @brief Exact solver for the maximum weight independent set of small graphs.
+ *
+ * Every connected component is solved on its own. Its vertices are renumbered by ascending weight
+ * and stored as rows of an adjacency matrix with 64 vertices per word, so the candidates of a branch
+ * are one bitset and taking a vertex removes its neighbors with a word-wise and-not.
+ *
+ * The upper bound of a node is a greedy weighted clique cover of its candidates: an independent set
+ * contains at most one vertex of every clique, so if every vertex weight is split over cliques that
+ * contain it, the total weight of the cliques bounds it. Cliques are grown from the lightest remaining
+ * candidate, which is the lowest bit set, and take the smallest remaining weight of their members, so
+ * a heavy vertex is shared by several cliques of lighter neighbors. The candidates are branched on in
+ * reverse order of being covered completely, where the bound of a vertex is the cover weight up to
+ * that point, and the loop stops once that bound cannot beat the best solution. Heavy vertices tend to
+ * be covered last and are branched on first, so the first dives reach heavy leaves early and a stop by
+ * a limit rarely ends below the greedy. Candidates at least as heavy as their candidate neighbors
+ * together are taken without branching.
+ *
+ * The search starts from a given solution and can be stopped by a node or time limit. The open
+ * bounds left on the stack then give the largest possible improvement, the optimality gap.
+ * Components above maxComponentSize vertices would need too large a matrix, they keep the given
+ * solution and count the weight of their other vertices as gap.
+ */
+class BranchAndBound
+{
+private:
+    const CSRGraph &_graph;                 // The graph
+    const vector<long long> &_weights;      // Weight of every vertex
+    vector<int> _best;                      // Best solution of the current component, local IDs
+    long long _bestWeight = 0;              // Weight of the best solution of the current component
+    vector<int> _current;                   // Vertices taken on the current branch, local IDs
+    vector<int> _localIDs;                  // ID of every vertex within its component
+    int _words = 0;                         // Words per row of the current component
+    vector<uint64_t> _adjacency;            // Adjacency matrix of the current component
+    vector<long long> _localWeights;        // Weight of every local vertex
+    vector<vector<uint64_t> > _candidates;  // Candidates at every depth
+    vector<vector<int> > _orders;           // Cover order of the candidates at every depth
+    vector<vector<long long> > _bounds;     // Cover weight up to the clique of every vertex in the order
+    vector<uint64_t> _remaining;            // Candidates not yet covered
+    vector<uint64_t> _clique;               // Candidates adjacent to the clique that is built
+    vector<int> _members;                   // Members of the clique that is built
+    vector<long long> _residuals;           // Weight of every candidate not yet covered by cliques
+    long long _openBound = 0;               // Largest bound left unexplored by a stop
+    long long _nodes = 0;                   // Number of search nodes
+    long long _nodeLimit = 0;               // Maximum number of search nodes, 0 for none
+    bool _timed = false;                    // Whether there is a deadline
+    chrono::steady_clock::time_point _deadline; // Time at which the search stops
+    bool _stopped = false;                  // Whether a limit was reached
+
+#ifdef AE_X86_SIMD
+    bool _useAVX2 = hasAVX2();
+#endif
+
+    const uint64_t *_row(int vertex) const { return &_adjacency[static_cast<size_t>(vertex) * _words]; }
+
+    bool _limitReached()
+    {
+        if (_stopped)
+            return true;
+        ++_nodes;
+        if ((_nodeLimit > 0 && _nodes > _nodeLimit) || (_timed && (_nodes & 1023) == 0 && chrono::steady_clock::now() >= _deadline))
+            _stopped = true;
+        return _stopped;
+    }
+
+    // Covers the candidates with weighted cliques and stores the cover order and the bounds of a depth
+    void _cover(int depth)
+    {
+        const uint64_t *candidates = _candidates[depth].data();
+        vector<int> &order = _orders[depth];
+        vector<long long> &bounds = _bounds[depth];
+        order.clear();
+        bounds.clear();
+        copy(candidates, candidates + _words, _remaining.begin());
+        for (int word = 0; word < _words; ++word)
+            for (uint64_t bits = candidates[word]; bits; bits &= bits - 1)
+            {
+                int vertex = word * 64 + __builtin_ctzll(bits);
+                _residuals[vertex] = _localWeights[vertex];
+            }
+
+        long long bound = 0;
+        for (int word = 0; word < _words; ++word)
+        {
+            while (_remaining[word])
+            {
+                // Grow a clique from the lightest remaining candidate, only words from here on are left
+                int vertex = word * 64 + __builtin_ctzll(_remaining[word]);
+                _members.assign(1, vertex);
+                long long cliqueWeight = _residuals[vertex];
+                for (int i = word; i < _words; ++i)
+                    _clique[i] = _remaining[i] & _row(vertex)[i];
+                for (int cliqueWord = word; cliqueWord < _words;)
+                {
+                    if (!_clique[cliqueWord])
+                    {
+                        ++cliqueWord;
+                        continue;
+                    }
+                    int member = cliqueWord * 64 + __builtin_ctzll(_clique[cliqueWord]);
+                    _members.push_back(member);
+                    cliqueWeight = min(cliqueWeight, _residuals[member]);
+                    for (int i = cliqueWord; i < _words; ++i)
+                        _clique[i] &= _row(member)[i];
+                }
+
+                // The clique covers the smallest residual weight of its members, the others stay
+                bound += cliqueWeight;
+                for (int member : _members)
+                {
+                    _residuals[member] -= cliqueWeight;
+                    if (_residuals[member] == 0)
+                    {
+                        _remaining[member >> 6] &= ~(uint64_t(1) << (member & 63));
+                        order.push_back(member);
+                        bounds.push_back(bound);
+                    }
+                }
+            }
+        }
+    }
+
+    // Takes every candidate at least as heavy as its candidate neighbors together, some optimal solution
+    // of the candidates contains it, and returns the weight taken
+    long long _takeHeavyCandidates(int depth)
+    {
+        uint64_t *candidates = _candidates[depth].data();
+        long long taken = 0;
+        bool changed = true;
+        while (changed)
+        {
+            changed = false;
+            for (int word = 0; word < _words; ++word)
+            {
+                uint64_t bits = candidates[word];
+                while (bits)
+                {
+                    int vertex = word * 64 + __builtin_ctzll(bits);
+                    bits &= bits - 1;
+                    if (!(candidates[word] >> (vertex & 63) & 1))
+                        continue;
+
+                    long long neighborhoodWeight = 0;
+                    const uint64_t *row = _row(vertex);
+                    for (int i = 0; i < _words && neighborhoodWeight <= _localWeights[vertex]; ++i)
+                        for (uint64_t neighbors = candidates[i] & row[i]; neighbors && neighborhoodWeight <= _localWeights[vertex]; neighbors &= neighbors - 1)
+                            neighborhoodWeight += _localWeights[i * 64 + __builtin_ctzll(neighbors)];
+                    if (neighborhoodWeight > _localWeights[vertex])
+                        continue;
+
+                    _current.push_back(vertex);
+                    taken += _localWeights[vertex];
+                    for (int i = 0; i < _words; ++i)
+                        candidates[i] &= ~row[i];
+                    candidates[word] &= ~(uint64_t(1) << (vertex & 63));
+                    bits &= candidates[word];
+                    changed = true;
+                }
+            }
+        }
+        return taken;
+    }
+
+    void _search(int depth, long long weight)
+    {
+        size_t taken = _current.size();
+        _branch(depth, weight + _takeHeavyCandidates(depth));
+        _current.resize(taken);
+    }
+
+    void _branch(int depth, long long weight)
+    {
+        if (weight > _bestWeight)
+        {
+            _best = _current;
+            _bestWeight = weight;
+        }
+
+        _candidates[depth + 1].resize(_words);
+        _cover(depth);
+        uint64_t *candidates = _candidates[depth].data();
+        uint64_t *next = _candidates[depth + 1].data();
+        const vector<int> &order = _orders[depth];
+        const vector<long long> &bounds = _bounds[depth];
+        for (int i = static_cast<int>(order.size()) - 1; i >= 0; --i)
+        {
+            // The bounds only shrink from here on
+            if (weight + bounds[i] <= _bestWeight)
+                return;
+            if (_limitReached())
+            {
+                _openBound = max(_openBound, weight + bounds[i]);
+                return;
+            }
+            AE_COUNT("branch and bound nodes", 1);
+
+            int vertex = order[i];
+#ifdef AE_X86_SIMD
+            if (_useAVX2)
+                avx2AndNot(next, candidates, _row(vertex), 0, _words);
+            else
+                scalarAndNot(next, candidates, _row(vertex), 0, _words);
+#else
+            scalarAndNot(next, candidates, _row(vertex), 0, _words);
+#endif
+            next[vertex >> 6] &= ~(uint64_t(1) << (vertex & 63));
+
+            _current.push_back(vertex);
+            _search(depth + 1, weight + _localWeights[vertex]);
+            _current.pop_back();
+            if (_stopped)
+            {
+                _openBound = max(_openBound, weight + bounds[i]);
+                return;
+            }
+            candidates[vertex >> 6] &= ~(uint64_t(1) << (vertex & 63));
+        }
+    }
+
+    // Solves one component, adds its solution to the independent set and returns its gap
+    long long _solveComponent(const vector<int> &component, const vector<char> &inInitial, vector<int> &independentSet)
+    {
+        int size = static_cast<int>(component.size());
+        vector<int> vertices = component;
+        sort(vertices.begin(), vertices.end(), [this](int a, int b)
+             { return _weights[a] < _weights[b] || (_weights[a] == _weights[b] && a < b); });
+
+        // Local IDs and adjacency matrix, self-loops are ignored
+        for (int i = 0; i < size; ++i)
+            _localIDs[vertices[i]] = i;
+        _words = (size + 63) / 64;
+        _adjacency.assign(static_cast<size_t>(size) * _words, 0);
+        _localWeights.resize(size);
+        _best.clear();
+        _bestWeight = 0;
+        for (int i = 0; i < size; ++i)
+        {
+            _localWeights[i] = _weights[vertices[i]];
+            if (inInitial[vertices[i]])
+            {
+                _best.push_back(i);
+                _bestWeight += _localWeights[i];
+            }
+            for (int neighbor : _graph.neighbors(vertices[i]))
+                if (neighbor != vertices[i])
+                    _adjacency[static_cast<size_t>(i) * _words + (_localIDs[neighbor] >> 6)] |= uint64_t(1) << (_localIDs[neighbor] & 63);
+        }
+
+        _candidates.resize(max<size_t>(_candidates.size(), size + 2));
+        _orders.resize(max<size_t>(_orders.size(), size + 1));
+        _bounds.resize(max<size_t>(_bounds.size(), size + 1));
+        _remaining.resize(_words);
+        _clique.resize(_words);
+        _residuals.resize(size);
+        _candidates[0].assign(_words, 0);
+        for (int i = 0; i < size; ++i)
+            _candidates[0][i >> 6] |= uint64_t(1) << (i & 63);
+
+        _openBound = 0;
+        _search(0, 0);
+
+        for (int vertex : _best)
+            independentSet.push_back(vertices[vertex]);
+        return max<long long>(0, _openBound - _bestWeight);
+    }
+
+public:
+    static const size_t maxComponentSize = 1 << 14; // Larger components keep the initial solution
+
+    /**
+     * @brief Creates a solver for a graph with non-negative weights
+     * @param graph The graph
+     * @param weights The weight of every vertex
+     */
+    BranchAndBound(const CSRGraph &graph, const vector<long long> &weights) : _graph(graph), _weights(weights) {}
+
+    /**
+     * @brief Searches for a maximum weight independent set
+     * @param initialSet An independent set to start from
+     * @param nodeLimit The maximum number of search nodes, 0 for none
+     * @param seconds The wall-clock budget, 0 for none
+     * @param gap Receives how much heavier than the result an optimal set can be, 0 if the result is optimal
+     * @return The best independent set found
+     */
+    vector<int> solve(const vector<int> &initialSet, long long nodeLimit, double seconds, long long &gap)
+    {
+        AE_PHASE("branch and bound");
+        int n = _graph.numberOfVertices();
+        _nodes = 0;
+        _nodeLimit = nodeLimit;
+        _timed = seconds > 0;
+        _deadline = chrono::steady_clock::now() + chrono::duration_cast<chrono::steady_clock::duration>(chrono::duration<double>(seconds));
+        _stopped = false;
+        gap = 0;
+
+        _localIDs.assign(n, -1);
+        vector<char> inInitial(n, 0);
+        for (int vertex : initialSet)
+            inInitial[vertex] = 1;
+
+        // Find the components with a breadth-first search
+        vector<int> independentSet;
+        vector<char> visited(n, 0);
+        vector<int> component;
+        for (int start = 0; start < n; ++start)
+        {
+            if (visited[start])
+                continue;
+            component.assign(1, start);
+            visited[start] = 1;
+            for (size_t i = 0; i < component.size(); ++i)
+                for (int neighbor : _graph.neighbors(component[i]))
+                    if (!visited[neighbor])
+                    {
+                        visited[neighbor] = 1;
+                        component.push_back(neighbor);
+                    }
+
+            if (component.size() == 1)
+                independentSet.push_back(start);
+            else if (component.size() <= maxComponentSize)
+                gap += _solveComponent(component, inInitial, independentSet);
+            else
+            {
+                // Too large for the adjacency matrix, keep the initial solution and bound it by the total weight
+                for (int vertex : component)
+                {
+                    if (inInitial[vertex])
+                        independentSet.push_back(vertex);
+                    else
+                        gap += _weights[vertex];
+                }
+            }
+        }
+        return independentSet;
     }
 };
 
@@ -57,8 +1050,8 @@ struct Node
  * @brief Class to represent a graph
  * @var Graph::_numberOfVertices
  * Member '_numberOfVertices' represents the number of vertices in the graph
- * @var Graph::_adjacencyList
- * Member '_adjacencyList' represents the adjacency list to represent the graph
+ * @var Graph::_graph
+ * Member '_graph' represents the CSR structure of the graph
  * @var Graph::_nodeList
  * Member '_nodeList' represents the list of nodes in the graph
  * @var Graph::_nodeQueue
@@ -66,118 +1059,434 @@ struct Node
  */
 class Graph
 {
+public:
+    /**
+     * @struct Options
+     * @brief Selects the algorithm of calculateMaxSet.
+     */
+    struct Options
+    {
+        bool staticGreedy = false;   // Scan once by static cost instead of the dynamic greedy
+        bool parallel = false;       // Decide by static cost in parallel rounds instead of the dynamic greedy
+        bool reduce = false;         // Shrink the graph with reduction rules before the greedy
+        bool exact = false;          // Solve with branch and bound instead of a greedy
+        long long nodeLimit = 0;     // Maximum number of branch and bound nodes, 0 for none
+        double timeLimit = 0;        // Seconds of local search after the greedy or limit of the branch and bound, 0 for none
+        unsigned long long seed = 0; // Seed of the local search and of the ties in the parallel rounds
+    };
+
 private:
     int _numberOfVertices;               // Number of vertices in the graph
-    vector<vector<Edge> > _adjacencyList; // Adjacency list to represent the graph
+    CSRGraph _graph;                     // CSR structure of the graph
     vector<Node> _nodeList;              // List of nodes in the graph
 
     /**
-     * @brief Calculates the cost of each vertex in the graph.
-     * @return * void
+     * @brief Returns the weight of every vertex, indexed by ID
      */
-    void _calculateVertexCost()
+    vector<long long> _weights() const
     {
-        for (Node &node : _nodeList)
-        {
-            int nodeCost = 0;
-            int nodeID = node.id;
-            for (const Edge &edge : _adjacencyList[nodeID])
-                nodeCost += _nodeList[edge.destination].weight;
+        vector<long long> weights(_numberOfVertices);
+        for (const Node &node : _nodeList)
+            weights[node.id] = node.weight;
+        return weights;
+    }
 
-            node.cost = sqrt(nodeCost + _adjacencyList[nodeID].size()) / node.weight;
+    /**
+     * @brief Runs the configured greedy on a graph, followed by the local search if it has a time budget,
+     * or the branch and bound starting from the better of the static and the dynamic greedy
+     * @param graph The graph, the input or a kernel
+     * @param weights The weight of every vertex
+     * @param options The algorithm to use
+     * @param gap Receives the optimality gap of the branch and bound, or -1 if there is no bound
+     * @return The chosen vertices
+     */
+    static vector<int> _solve(const CSRGraph &graph, const vector<long long> &weights, const Options &options, long long &gap)
+    {
+        gap = -1;
+        if (options.exact)
+        {
+            // Start from the better greedy, a stop by a limit never returns less than the default mode
+            vector<int> staticSet = staticGreedy(graph, weights);
+            vector<int> dynamicSet = dynamicGreedy(graph, weights);
+            auto totalWeight = [&weights](const vector<int> &independentSet)
+            {
+                long long total = 0;
+                for (int vertex : independentSet)
+                    total += weights[vertex];
+                return total;
+            };
+            const vector<int> &initialSet = totalWeight(dynamicSet) > totalWeight(staticSet) ? dynamicSet : staticSet;
+            return BranchAndBound(graph, weights).solve(initialSet, options.nodeLimit, options.timeLimit, gap);
         }
+
+        vector<int> independentSet;
+        if (options.parallel)
+            independentSet = parallelGreedy(graph, weights, options.seed);
+        else if (options.staticGreedy)
+            independentSet = staticGreedy(graph, weights);
+        else
+            independentSet = dynamicGreedy(graph, weights);
+        if (options.timeLimit > 0)
+            independentSet = LocalSearch(graph, weights, independentSet, options.seed).run(options.timeLimit);
+        return independentSet;
+    }
+
+    /**
+     * @brief Prints the number of chosen vertices, their total weight, their IDs in ascending order and
+     * the optimality gap if there is one
+     * @param independentSet The chosen vertices
+     * @param gap The optimality gap, or -1 if there is none
+     */
+    void _printSet(vector<int> independentSet, long long gap = -1)
+    {
+        AE_PHASE("output");
+        long long totalWeightOfSelectedNodes = 0;
+        for (int vertex : independentSet)
+            totalWeightOfSelectedNodes += _nodeList[vertex].weight;
+        sort(independentSet.begin(), independentSet.end());
+
+        ResultWriter out;
+        out << independentSet.size() << '\n'
+            << totalWeightOfSelectedNodes << '\n';
+        for (int vertex : independentSet)
+            out << vertex + 1 << ' ';
+        out << '\n';
+        if (gap >= 0)
+            out << gap << '\n';
     }
 
 public:
+
     // Constructor
-    Graph(int vertices) : _numberOfVertices(vertices)
+    Graph(CSRGraph graph) : _numberOfVertices(graph.numberOfVertices()), _graph(move(graph))
     {
-        _adjacencyList.resize(_numberOfVertices);
         _nodeList.reserve(_numberOfVertices);
     }
 
     /**
-     * @brief Function to add an edge to the graph
-     * @param source Source vertex of the edge
-     * @param destination Destination vertex of the edge
-     * @param weight Weight of the edge
+     * @brief Function to add a node to the graph
+     * @param id ID of the node
+     * @param weight Weight of the node
      */
-    void addEdge(int source, int destination, int weight)
+    void addNode(int id, int weight)
     {
-        _adjacencyList[source - 1].push_back(Edge(destination - 1, weight));
+        _nodeList.emplace_back(id, weight);
     }
 
     /**
-     * @brief Function to add a node to the graph
-     * @param id ID of the node
-     * @param degree Degree of the node
-     * @param weight Weight of the node
-     * @param blocked Node blocked for further expansion
-     * @param chosen Node chosen for set
+     * @brief Calculates the cost of each vertex in the graph.
+     * @param graph The graph
+     * @param weights The weight of every vertex
+     * @return The cost of every vertex, cheaper vertices are picked first
      */
-    void addNode(int id, int weight, float cost = 0, bool blocked = false, bool chosen = false)
+    static vector<float> calculateVertexCosts(const CSRGraph &graph, const vector<long long> &weights)
     {
-        _nodeList.emplace_back(Node(id, weight, cost, blocked, chosen));
+        vector<float> costs(graph.numberOfVertices());
+        parallelFor(0, graph.numberOfVertices(), [&](int, int64_t first, int64_t last)
+                    {
+                        for (int vertex = static_cast<int>(first); vertex < last; ++vertex)
+                        {
+                            long long nodeCost = 0;
+                            for (int destination : graph.neighbors(vertex))
+                                nodeCost += weights[destination];
+
+                            costs[vertex] = sqrt(nodeCost + graph.degree(vertex)) / weights[vertex];
+                        }
+                    });
+        return costs;
     }
 
     /**
-     * @brief Calculates the maximum set of nodes based on a priority queue.
-     * @return * void
+     * @brief Picks vertices once in order of their static cost, skipping blocked ones.
+     * @param graph The graph
+     * @param weights The weight of every vertex
+     * @return The chosen vertices
      */
-    void calculateMaxSet()
+    static vector<int> staticGreedy(const CSRGraph &graph, const vector<long long> &weights)
     {
-        int selectedNodeCount = 0;
-        int totalWeightOfSelectedNodes = 0;
-
-        _calculateVertexCost();
+        int n = graph.numberOfVertices();
+        vector<float> costs = calculateVertexCosts(graph, weights);
 
         // Sort the vertices based on their cost
-        sort(_nodeList.begin(), _nodeList.end(), [](const Node &a, const Node &b)
-             { return a.cost < b.cost; });
+        vector<int> order(n);
+        for (int vertex = 0; vertex < n; ++vertex)
+            order[vertex] = vertex;
+        stable_sort(order.begin(), order.end(), [&costs](int a, int b)
+                    { return costs[a] < costs[b]; });
 
-        for (Node &node : _nodeList)
+        vector<char> blocked(n, 0);
+        vector<int> independentSet;
+        for (int vertex : order)
         {
-            if (!node.blocked)
+            if (blocked[vertex])
+                continue;
+            independentSet.push_back(vertex);
+
+            // Block all nodes adjacent to the current node
+            blocked[vertex] = 1;
+            for (int destinationNode : graph.neighbors(vertex))
+                blocked[destinationNode] = 1;
+        }
+        return independentSet;
+    }
+
+    /**
+     * @brief Dynamic greedy for the maximum weight independent set (GWMIN2).
+     *
+     * Repeatedly takes the vertex with the largest priority w(v) / w(N[v]), where N[v] are v and its
+     * neighbors that are still in the graph, and removes it with its neighbors. Removing a neighbor u
+     * lowers the residual neighborhood weight of the neighbors of u, which raises their priority. The
+     * priorities are kept in a lazily updated heap: a change pushes a new entry and entries whose
+     * priority no longer matches are skipped, so the run takes O(m log n).
+     *
+     * @param graph The graph
+     * @param weights The weight of every vertex, non-negative
+     * @return The chosen vertices
+     */
+    static vector<int> dynamicGreedy(const CSRGraph &graph, const vector<long long> &weights)
+    {
+        int n = graph.numberOfVertices();
+        vector<long long> neighborhoodWeights(n);
+        vector<double> priorities(n);
+        vector<char> removed(n, 0);
+
+        auto priority = [&](int vertex)
+        {
+            return neighborhoodWeights[vertex] > 0 ? static_cast<double>(weights[vertex]) / neighborhoodWeights[vertex] : 1.0;
+        };
+
+        priority_queue<pair<double, int> > heap;
+        for (int vertex = 0; vertex < n; ++vertex)
+        {
+            neighborhoodWeights[vertex] = weights[vertex];
+            for (int destination : graph.neighbors(vertex))
+                if (destination != vertex)
+                    neighborhoodWeights[vertex] += weights[destination];
+            priorities[vertex] = priority(vertex);
+            heap.emplace(priorities[vertex], vertex);
+        }
+
+        vector<int> independentSet;
+        while (!heap.empty())
+        {
+            pair<double, int> entry = heap.top();
+            heap.pop();
+            int vertex = entry.second;
+            if (removed[vertex] || entry.first != priorities[vertex])
+                continue;
+
+            independentSet.push_back(vertex);
+            removed[vertex] = 1;
+            for (int neighbor : graph.neighbors(vertex))
             {
-                node.chosen = true;
-                selectedNodeCount++;
-                totalWeightOfSelectedNodes += node.weight;
+                if (removed[neighbor])
+                    continue;
+                removed[neighbor] = 1;
 
-                // Block all nodes adjacent to the current node
-                for (const Edge &edge : _adjacencyList[node.id])
+                // The neighbor leaves the residual graph, its other neighbors gain priority
+                for (int secondNeighbor : graph.neighbors(neighbor))
                 {
-                    int destinationNode = edge.destination;
-                    // Only block the node if it hasn't been chosen
-                    if (!_nodeList[destinationNode].chosen)
-                        _nodeList[destinationNode].blocked = true;
+                    if (removed[secondNeighbor])
+                        continue;
+                    neighborhoodWeights[secondNeighbor] -= weights[neighbor];
+                    priorities[secondNeighbor] = priority(secondNeighbor);
+                    heap.emplace(priorities[secondNeighbor], secondNeighbor);
+                    AE_COUNT("priority updates", 1);
                 }
             }
         }
+        return independentSet;
+    }
 
-        cout << selectedNodeCount << endl
-             << totalWeightOfSelectedNodes << endl;
+    /**
+     * @brief Parallel greedy that decides the vertices in rounds (Luby style).
+     *
+     * Vertices are ranked by their static cost, ties are broken by a hash of the vertex ID and the seed.
+     * In every round each undecided vertex that ranks before all of its undecided neighbors joins the
+     * set and its neighbors are blocked. The local maxima of a round are independent, so the winners
+     * are first collected without writing any state, then their neighbors are blocked with atomic
+     * stores. The undecided vertices are compacted into the frontier of the next round with a prefix
+     * sum over per-thread counts. The result is the set the sequential scan in rank order would pick,
+     * so it only depends on the seed and not on the number of threads.
+     *
+     * @param graph The graph
+     * @param weights The weight of every vertex
+     * @param seed The seed for breaking ties between equal costs
+     * @return The chosen vertices
+     */
+    static vector<int> parallelGreedy(const CSRGraph &graph, const vector<long long> &weights, unsigned long long seed)
+    {
+        enum : unsigned char { UNDECIDED, CHOSEN, BLOCKED };
+        int n = graph.numberOfVertices();
+        vector<float> costs = calculateVertexCosts(graph, weights);
+        vector<unsigned long long> ranks(n);
+        vector<atomic<unsigned char> > states(n);
+        vector<int> frontier(n);
+        parallelFor(0, n, [&](int, int64_t first, int64_t last)
+                    {
+                        for (int64_t vertex = first; vertex < last; ++vertex)
+                        {
+                            // SplitMix64 finalizer for the tie breaker
+                            unsigned long long hash = seed + 0x9e3779b97f4a7c15ULL * (vertex + 1);
+                            hash = (hash ^ (hash >> 30)) * 0xbf58476d1ce4e5b9ULL;
+                            hash = (hash ^ (hash >> 27)) * 0x94d049bb133111ebULL;
 
-        for (const Node &node : _nodeList)
-            if (node.chosen)
-                cout << node.id + 1 << " ";
+                            // The bits of a non-negative float order like the float itself
+                            uint32_t costBits;
+                            memcpy(&costBits, &costs[vertex], sizeof(costBits));
+                            ranks[vertex] = (static_cast<unsigned long long>(costBits) << 32) | ((hash ^ (hash >> 31)) >> 32);
+                            states[vertex].store(UNDECIDED, memory_order_relaxed);
+                            frontier[vertex] = static_cast<int>(vertex);
+                        }
+                    });
+
+        auto before = [&](int a, int b)
+        { return ranks[a] < ranks[b] || (ranks[a] == ranks[b] && a < b); };
+
+        vector<vector<int> > winners(numberOfThreads());
+        vector<int64_t> survivors(numberOfThreads() + 1);
+        vector<int> nextFrontier(n);
+        while (!frontier.empty())
+        {
+            AE_COUNT("rounds", 1);
+            int64_t size = static_cast<int64_t>(frontier.size());
 
-        cout << endl;
+            // Find the local maxima, nothing is written to the states here
+            int blocks = parallelFor(0, size, [&](int threadID, int64_t first, int64_t last)
+                                     {
+                                         vector<int> &threadWinners = winners[threadID];
+                                         threadWinners.clear();
+                                         for (int64_t i = first; i < last; ++i)
+                                         {
+                                             int vertex = frontier[i];
+                                             bool maximum = true;
+                                             for (int neighbor : graph.neighbors(vertex))
+                                                 if (neighbor != vertex && states[neighbor].load(memory_order_relaxed) == UNDECIDED && before(neighbor, vertex))
+                                                 {
+                                                     maximum = false;
+                                                     break;
+                                                 }
+                                             if (maximum)
+                                                 threadWinners.push_back(vertex);
+                                         }
+                                     });
+
+            // Take the winners and block their neighbors
+            parallelRun(blocks, [&](int threadID)
+                        {
+                            for (int vertex : winners[threadID])
+                            {
+                                states[vertex].store(CHOSEN, memory_order_relaxed);
+                                for (int neighbor : graph.neighbors(vertex))
+                                    if (neighbor != vertex)
+                                        states[neighbor].store(BLOCKED, memory_order_relaxed);
+                            }
+                        });
+
+            // Compact the undecided vertices into the next frontier, keeping their order
+            parallelFor(0, size, [&](int threadID, int64_t first, int64_t last)
+                        {
+                            int64_t count = 0;
+                            for (int64_t i = first; i < last; ++i)
+                                count += states[frontier[i]].load(memory_order_relaxed) == UNDECIDED;
+                            survivors[threadID + 1] = count;
+                        });
+            survivors[0] = 0;
+            for (int block = 0; block < blocks; ++block)
+                survivors[block + 1] += survivors[block];
+            parallelFor(0, size, [&](int threadID, int64_t first, int64_t last)
+                        {
+                            int64_t position = survivors[threadID];
+                            for (int64_t i = first; i < last; ++i)
+                                if (states[frontier[i]].load(memory_order_relaxed) == UNDECIDED)
+                                    nextFrontier[position++] = frontier[i];
+                        });
+            nextFrontier.resize(survivors[blocks]);
+            frontier.swap(nextFrontier);
+            nextFrontier.resize(frontier.size());
+        }
+
+        vector<int> independentSet;
+        for (int vertex = 0; vertex < n; ++vertex)
+            if (states[vertex].load(memory_order_relaxed) == CHOSEN)
+                independentSet.push_back(vertex);
+        return independentSet;
+    }
+
+    /**
+     * @brief Calculates a maximum weight independent set and prints it.
+     * @param options The algorithm to use
+     */
+    void calculateMaxSet(const Options &options)
+    {
+        vector<int> independentSet;
+        long long gap;
+        {
+            AE_PHASE("algorithm");
+            vector<long long> weights = _weights();
+            if (!options.reduce)
+                independentSet = _solve(_graph, weights, options, gap);
+            else
+            {
+                // Solve the kernel and lift its solution back to the input graph
+                Reducer reducer(_graph, weights);
+                reducer.reduce();
+
+                vector<int> kernelVertices;
+                vector<long long> kernelWeights;
+                CSRGraph kernel = reducer.kernel(kernelVertices, kernelWeights);
+                AE_COUNT("kernel vertices", kernel.numberOfVertices());
+
+                vector<int> kernelSet = _solve(kernel, kernelWeights, options, gap);
+                for (int &vertex : kernelSet)
+                    vertex = kernelVertices[vertex];
+                independentSet = reducer.lift(kernelSet);
+            }
+        }
+
+        _printSet(independentSet, gap);
     }
-    /*
-    2
-    7
-    7 3
-    */
 };
 
 /**
  * @brief Main function
  * @return 0 on successful execution
  */
-int main()
+int main(int argc, char *argv[])
 {
-    ifstream file("/Users/jan/Documents/code/AlgorithmEngineering/example4.txt");
-    if (!file.is_open())
+    // "ex4 <file|-> [--static|--parallel|--exact] [--reduce] [--node-limit N] [--time-limit S] [--seed S]",
+    // --static scans once by static cost instead of running the dynamic greedy, --parallel picks by static
+    // cost in parallel rounds, --exact runs branch and bound and prints the optimality gap as last line,
+    // --reduce applies the reduction rules first and solves the kernel, --time-limit improves the greedy
+    // solution with local search for S seconds or stops the branch and bound like --node-limit
+    Graph::Options options;
+    for (int i = 2; i < argc; ++i)
+    {
+        string option = argv[i];
+        if (option == "--static")
+            options.staticGreedy = true;
+        else if (option == "--parallel")
+            options.parallel = true;
+        else if (option == "--reduce")
+            options.reduce = true;
+        else if (option == "--exact")
+            options.exact = true;
+        else if (option == "--node-limit" && i + 1 < argc)
+            options.nodeLimit = atoll(argv[++i]);
+        else if (option == "--time-limit" && i + 1 < argc)
+            options.timeLimit = atof(argv[++i]);
+        else if (option == "--seed" && i + 1 < argc)
+            options.seed = strtoull(argv[++i], nullptr, 10);
+        else
+        {
+            cerr << "Unknown option " << option << "." << endl;
+            return 1;
+        }
+    }
+
+    // Read from the file given as first argument, or from standard input
+    GraphReader file(argc > 1 ? argv[1] : nullptr);
+    if (!file.isOpen())
     {
         cerr << "Failed to open the file." << endl;
         return 1;
@@ -190,26 +1499,23 @@ int main()
     int numberOfNodes, numberOfEdges;
     file >> numberOfNodes >> numberOfEdges;
 
-    // Create a graph
-    Graph G(numberOfNodes);
-
-    // Add edges to the graph
-    for (int line = 0; line < numberOfEdges * 2; ++line)
+    // Read the edges and create a graph with the read number of nodes
+    Graph G(file.readGraph(numberOfNodes, 2 * static_cast<int64_t>(numberOfEdges)));
+    if (!file)
     {
-        int source, destination, weight;
-        file >> source >> destination >> weight;
-        G.addEdge(source, destination, weight);
+        cerr << "Invalid graph input." << endl;
+        return 1;
     }
 
     // Add nodes to the graph
     for (int line = 0; line < numberOfNodes; ++line)
     {
-        int weight;
+        int weight = 0;
         file >> weight;
         G.addNode(line, weight);
     }
 
-    G.calculateMaxSet();
+    G.calculateMaxSet(options);
 
     return 0;
 }
\ No newline at end of file
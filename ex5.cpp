@@ -1,6 +1,14 @@
 #include <vector>
 #include <iostream>
 #include <queue>
+#include <algorithm>
+#include <limits>
+#include <string>
+
+#include "csr_graph.h"
+#include "graph_reader.h"
+#include "instrumentation.h"
+#include "result_writer.h"
 
 using namespace std;
 
@@ -22,37 +30,15 @@ struct Node
     Node(int id) : id(id), level(-1) {}
 };
 
-/**
- * @struct Edge
- * @brief Structure to represent an edge in the graph.
- * @param source The source vertex of the edge.
- * @param destination The destination vertex of the edge.
- * @param flow The current flow in this edge.
- * @param capacity The capacity of the edge.
- */
-struct Edge
-{
-    int source;      // Source vertex of the edge
-    int destination; // Destination vertex of the edge
-    int flow;        // Current flow in this edge
-    int capacity;    // Capacity of the edge
-
-    /**
-     * @brief Constructor for Edge.
-     * @param src The source vertex of the edge.
-     * @param dest The destination vertex of the edge.
-     * @param cap The capacity of the edge.
-     */
-    Edge(int src, int dest, int cap) : source(src), destination(dest), flow(0), capacity(cap) {}
-};
-
 /**
  * @class Graph
  * @brief Class to represent a graph.
  * @param _numberOfVertices The number of vertices in the graph.
  * @param _sourceID The source vertex for the flow.
  * @param _targetID The target vertex for the flow.
- * @param _adjacencyList The adjacency list to represent the graph.
+ * @param _graph The CSR structure of the flow network, arc weights are the capacities.
+ * @param _twins The reverse arc of every arc of the flow network.
+ * @param _residualCapacities The capacity minus the current flow of every arc of the graph.
  * @param _nodeList The list of nodes in the graph.
  */
 class Graph
@@ -61,9 +47,121 @@ private:
     int _numberOfVertices;               // Number of vertices in the graph
     int _sourceID;                       // Source vertex for the flow
     int _targetID;                       // Target vertex for the flow
-    vector<vector<Edge> > _adjacencyList; // Adjacency list to represent the graph
+    CSRGraph _graph;                     // CSR structure of the flow network
+    vector<int64_t> _twins;              // Reverse arc of every arc
+    vector<int64_t> _residualCapacities; // Capacity minus the current flow of every arc
     vector<Node> _nodeList;              // List of nodes in the graph
 
+    /**
+     * @brief Function to pair every arc with a reverse arc.
+     *
+     * An arc u->v is paired with an arc v->u of the input if there is one left, so an undirected edge
+     * listed in both directions keeps its two arcs. Arcs without a partner, as in directed inputs,
+     * get a new reverse arc with zero capacity that only carries the residual capacity of the flow.
+     * Within the arcs of a vertex the input arcs keep their order and the new arcs follow them.
+     * Self-loops never carry flow between different vertices and get a new reverse arc as well.
+     *
+     * The pairs of u < v are matched at u: a counting sort groups the arcs v->u by u and sorts them by v,
+     * then every arc u->v takes the next free one from v, so the whole pairing runs in linear time.
+     */
+    void _pairArcs()
+    {
+        AE_PHASE("build");
+        int64_t numberOfArcs = _graph.numberOfArcs();
+
+        // Arcs v->u with v > u, grouped by u and sorted by v
+        vector<int64_t> inOffsets(_numberOfVertices + 1, 0);
+        for (int vertex = 0; vertex < _numberOfVertices; ++vertex)
+            for (int destination : _graph.neighbors(vertex))
+                if (destination < vertex)
+                    inOffsets[destination + 1]++;
+        for (int vertex = 0; vertex < _numberOfVertices; ++vertex)
+            inOffsets[vertex + 1] += inOffsets[vertex];
+        vector<int64_t> incoming(inOffsets[_numberOfVertices]);
+        vector<int> incomingSources(inOffsets[_numberOfVertices]);
+        {
+            vector<int64_t> position(inOffsets.begin(), inOffsets.end() - 1);
+            for (int vertex = 0; vertex < _numberOfVertices; ++vertex)
+                for (int64_t arc = _graph.firstArc(vertex); arc < _graph.lastArc(vertex); ++arc)
+                    if (_graph.target(arc) < vertex)
+                    {
+                        int64_t slot = position[_graph.target(arc)]++;
+                        incoming[slot] = arc;
+                        incomingSources[slot] = vertex;
+                    }
+        }
+
+        // Match the arcs u->v with the arcs v->u, -1 marks arcs without a partner. The arcs from v
+        // are contiguous, so head[v] is the next one of them that is still free.
+        vector<int64_t> partner(numberOfArcs, -1);
+        vector<int64_t> head(_numberOfVertices, -1);
+        for (int vertex = 0; vertex < _numberOfVertices; ++vertex)
+        {
+            for (int64_t slot = inOffsets[vertex + 1] - 1; slot >= inOffsets[vertex]; --slot)
+                head[incomingSources[slot]] = slot;
+            for (int64_t arc = _graph.firstArc(vertex); arc < _graph.lastArc(vertex); ++arc)
+            {
+                int destination = _graph.target(arc);
+                if (destination <= vertex)
+                    continue;
+                int64_t slot = head[destination];
+                if (slot != -1 && slot < inOffsets[vertex + 1] && incomingSources[slot] == destination)
+                {
+                    partner[arc] = incoming[slot];
+                    partner[incoming[slot]] = arc;
+                    head[destination] = slot + 1;
+                }
+            }
+            for (int64_t slot = inOffsets[vertex]; slot < inOffsets[vertex + 1]; ++slot)
+                head[incomingSources[slot]] = -1;
+        }
+
+        // Inputs that list both directions of every edge need no new arcs
+        int64_t unpaired = count(partner.begin(), partner.end(), int64_t(-1));
+        AE_COUNT("reverse arcs added", unpaired);
+        if (unpaired == 0)
+        {
+            _twins = move(partner);
+            return;
+        }
+
+        // The input arcs keep their order, the new reverse arcs are appended behind them
+        vector<InputEdge> edges;
+        edges.reserve(numberOfArcs + unpaired);
+        for (int vertex = 0; vertex < _numberOfVertices; ++vertex)
+            for (int64_t arc = _graph.firstArc(vertex); arc < _graph.lastArc(vertex); ++arc)
+                edges.push_back({vertex, _graph.target(arc), _graph.weight(arc)});
+        for (int vertex = 0; vertex < _numberOfVertices; ++vertex)
+            for (int64_t arc = _graph.firstArc(vertex); arc < _graph.lastArc(vertex); ++arc)
+                if (partner[arc] == -1)
+                    edges.push_back({_graph.target(arc), vertex, 0});
+        CSRGraph network(_numberOfVertices, edges);
+
+        // Translate the pairs to the arc indices of the network
+        _twins.assign(network.numberOfArcs(), -1);
+        vector<int64_t> nextNewArc(_numberOfVertices);
+        for (int vertex = 0; vertex < _numberOfVertices; ++vertex)
+            nextNewArc[vertex] = network.firstArc(vertex) + _graph.degree(vertex);
+        for (int vertex = 0; vertex < _numberOfVertices; ++vertex)
+            for (int64_t arc = _graph.firstArc(vertex); arc < _graph.lastArc(vertex); ++arc)
+            {
+                int64_t networkArc = network.firstArc(vertex) + (arc - _graph.firstArc(vertex));
+                if (partner[arc] != -1)
+                {
+                    int destination = _graph.target(arc);
+                    _twins[networkArc] = network.firstArc(destination) + (partner[arc] - _graph.firstArc(destination));
+                }
+                else
+                {
+                    int64_t reverseArc = nextNewArc[_graph.target(arc)]++;
+                    _twins[networkArc] = reverseArc;
+                    _twins[reverseArc] = networkArc;
+                }
+            }
+
+        _graph = move(network);
+    }
+
     /**
      * @brief Function to perform Breadth-First Search (BFS) in the residual graph.
      *
@@ -93,18 +191,18 @@ private:
             Node &currentNode = _nodeList[currentNodeID];
 
             // Traverse all edges of current node
-            for (Edge &edge : _adjacencyList[currentNodeID])
+            for (int64_t arc = _graph.firstArc(currentNodeID); arc < _graph.lastArc(currentNodeID); ++arc)
             {
-                Node &destinationNode = _nodeList[edge.destination];
+                Node &destinationNode = _nodeList[_graph.target(arc)];
 
                 // If residual capacity of an edge is greater than 0 and the destination node has not been visited, then visit the node
-                if (edge.capacity > edge.flow && destinationNode.level == -1)
+                if (_residualCapacities[arc] > 0 && destinationNode.level == -1)
                 {
                     // Assign level to destination node
                     destinationNode.level = currentNode.level + 1;
 
                     // Enqueue destination node
-                    q.push(edge.destination);
+                    q.push(_graph.target(arc));
                 }
             }
         }
@@ -114,86 +212,105 @@ private:
     }
 
     /**
-     * @brief Function to send flow from source to target.
+     * @brief Function to send a blocking flow from source to target.
      *
-     * This function uses Depth-First Search (DFS) to find a path from the current node to the target node.
-     * It also updates the flow along the path found.
+     * This function uses an iterative Depth-First Search (DFS) in the layered residual graph with an explicit stack.
+     * A node forwards the flow it receives over as many arcs as needed, so one descent pushes flow along many paths.
+     * Flow that reaches the target is returned through the stack and added to the arcs on the way back.
+     * A node is left once its incoming flow is used up or it has no admissible arc left.
      *
-     * @param currentNodeID The ID of the current node.
-     * @param currentFlow The current flow.
-     * @param visited The visited nodes.
+     * @param visited The current arc of every node, arcs before it are saturated or lead to dead ends.
      * @return The flow sent.
      */
-    int _sendFlow(int currentNodeID, int currentFlow, vector<int> &visited)
+    int64_t _sendFlow(vector<int64_t> &visited)
     {
-        // If the current node is the target node, return the current flow
-        if (currentNodeID == _targetID)
+        // The frames of the nodes on the current path, each with the flow it may send and the flow sent so far
+        struct Frame
         {
-            return currentFlow;
-        }
-
-        // Traverse all edges of the current node
-        for (int &currentID = visited[currentNodeID]; currentID < _adjacencyList[currentNodeID].size(); ++currentID)
+            int node;      // ID of the node
+            int64_t limit; // Flow the node received
+            int64_t sent;  // Flow the node already forwarded
+        };
+        vector<Frame> stack;
+        stack.push_back({_sourceID, numeric_limits<int64_t>::max(), 0});
+
+        while (true)
         {
-            Edge &edge = _adjacencyList[currentNodeID][currentID];
+            Frame &frame = stack.back();
+            int currentNodeID = frame.node;
 
-            // If the residual capacity of the edge is greater than 0 and the level of the destination node is level of current node + 1
-            if (edge.capacity - edge.flow > 0 && _nodeList[edge.destination].level == _nodeList[currentNodeID].level + 1)
+            // The target absorbs everything it receives
+            if (currentNodeID == _targetID)
             {
-                // Find the minimum of the current flow and the residual capacity of the edge
-                currentFlow = min(currentFlow, edge.capacity - edge.flow);
-
-                // Recursively call the function for the destination node
-                int tempFlow = _sendFlow(edge.destination, currentFlow, visited);
+                frame.sent = frame.limit;
+                AE_COUNT("augmentations", 1);
+            }
 
-                // If flow is sent from the destination node
-                if (tempFlow > 0)
+            // Search the next arc with residual capacity into the next level
+            bool advanced = false;
+            if (frame.sent < frame.limit && currentNodeID != _targetID)
+            {
+                for (int64_t &arc = visited[currentNodeID]; arc < _graph.lastArc(currentNodeID); ++arc)
                 {
-                    // Add the flow to the current edge
-                    edge.flow += tempFlow;
-
-                    // Subtract the flow from the reverse edge
-                    for (Edge &reverseEdge : _adjacencyList[edge.destination])
+                    int destination = _graph.target(arc);
+                    int64_t residual = _residualCapacities[arc];
+                    if (residual > 0 && _nodeList[destination].level == _nodeList[currentNodeID].level + 1)
                     {
-                        if (reverseEdge.destination == edge.source)
-                        {
-                            reverseEdge.flow -= tempFlow;
-                            break;
-                        }
+                        stack.push_back({destination, min(frame.limit - frame.sent, residual), 0});
+                        advanced = true;
+                        break;
                     }
-
-                    // Return the flow sent
-                    return tempFlow;
                 }
             }
+            if (advanced)
+                continue;
+
+            // The node is done, hand the flow it forwarded back to its parent
+            Frame child = stack.back();
+            stack.pop_back();
+            if (stack.empty())
+                return child.sent;
+
+            Frame &parent = stack.back();
+            int64_t arc = visited[parent.node];
+            _residualCapacities[arc] -= child.sent;
+            _residualCapacities[_twins[arc]] += child.sent;
+            parent.sent += child.sent;
+
+            // A child that could not forward everything it was offered is blocked
+            if (child.sent < child.limit)
+                ++visited[parent.node];
         }
-
-        // If no path is found, return 0
-        return 0;
     }
 
     /**
      * @brief Function to find nodes in the computed cut.
      *
-     * This function uses Depth-First Search (DFS) to find all nodes that can be reached from the source node in the residual graph.
+     * This function uses an iterative Depth-First Search (DFS) to find all nodes that can be reached from the source node in the residual graph.
      * The visited nodes represent the set of nodes in the computed cut.
      *
      * @param visited A vector to keep track of visited nodes.
-     * @param currentNodeID The ID of the current node.
      */
-    void _findNodesInComputedCut(vector<bool> &visited, int currentNodeID)
+    void _findNodesInComputedCut(vector<bool> &visited)
     {
-        // Mark the current node as visited
-        visited[currentNodeID] = true;
+        // Mark the source node as visited
+        visited[_sourceID] = true;
+        vector<int> stack(1, _sourceID);
 
-        // Traverse all edges of the current node
-        for (const Edge &edge : _adjacencyList[currentNodeID])
+        while (!stack.empty())
         {
-            // If the destination node has not been visited and the residual capacity of the edge is greater than 0
-            if (!visited[edge.destination] && edge.capacity - edge.flow > 0)
+            int currentNodeID = stack.back();
+            stack.pop_back();
+
+            // Traverse all edges of the current node
+            for (int64_t arc = _graph.firstArc(currentNodeID); arc < _graph.lastArc(currentNodeID); ++arc)
             {
-                // Recursively call the function for the destination node
-                _findNodesInComputedCut(visited, edge.destination);
+                // If the destination node has not been visited and the residual capacity of the edge is greater than 0
+                if (!visited[_graph.target(arc)] && _residualCapacities[arc] > 0)
+                {
+                    visited[_graph.target(arc)] = true;
+                    stack.push_back(_graph.target(arc));
+                }
             }
         }
     }
@@ -202,48 +319,34 @@ public:
     /**
      * @brief Constructor for Graph.
      *
-     * This constructor initializes the graph with the specified number of vertices.
-     * It resizes the adjacency list to hold the edges for each vertex and reserves space for the node list.
-     * It also creates a node for each vertex and adds it to the node list.
+     * This constructor takes over the CSR structure of the graph, pairs every arc with a reverse arc and starts with zero flow on every arc.
+     * It reserves space for the node list and creates a node for each vertex.
      *
-     * @param vertices The number of vertices in the graph.
+     * @param graph The CSR structure of the graph, arc weights are the capacities. Both directed and undirected inputs are supported.
      */
-    Graph(int vertices) : _numberOfVertices(vertices)
+    Graph(CSRGraph graph) : _numberOfVertices(graph.numberOfVertices()), _graph(move(graph))
     {
-        // Resize the adjacency list to hold the edges for each vertex
-        _adjacencyList.resize(_numberOfVertices);
+        // Pair every arc with its reverse arc
+        _pairArcs();
+
+        // Start with zero flow on every arc, the residual capacities are 64-bit so large flows cannot overflow
+        _residualCapacities.assign(_graph.weights(), _graph.weights() + _graph.numberOfArcs());
 
         // Reserve space for the node list
         _nodeList.reserve(_numberOfVertices);
 
         // Create a node for each vertex and add it to the node list
-        for (int i = 0; i < vertices; ++i)
+        for (int i = 0; i < _numberOfVertices; ++i)
         {
             _nodeList.emplace_back(i);
         }
     }
 
-    /**
-     * @brief Function to add an edge to the graph.
-     *
-     * This function adds an edge from the source vertex to the destination vertex with the specified capacity.
-     * The edge is added to the adjacency list of the source vertex.
-     * The vertices are decremented by 1 because they are 0-indexed in the adjacency list.
-     *
-     * @param source The source vertex of the edge.
-     * @param destination The destination vertex of the edge.
-     * @param capacity The capacity of the edge.
-     */
-    void addEdge(int source, int destination, int capacity)
-    {
-        _adjacencyList[source - 1].push_back(Edge(source - 1, destination - 1, capacity));
-    }
-
     /**
      * @brief Function to set source and target vertices.
      *
      * This function sets the source and target vertices for the flow.
-     * The IDs are decremented by 1 because the vertices are 0-indexed in the adjacency list and node list.
+     * The IDs are decremented by 1 because the vertices are 0-indexed in the node list.
      *
      * @param sourceID The ID of the source vertex.
      * @param targetID The ID of the target vertex.
@@ -275,68 +378,91 @@ public:
             return;
         }
 
-        // Initialize the maximum flow as 0
-        int maxFlow = 0;
-
-        // While there is a path from the source to the target in the residual graph
-        while (_BFS())
+        // Initialize the maximum flow as 0 and the visited nodes
+        int64_t maxFlow = 0;
+        vector<bool> visited(_numberOfVertices, false);
         {
-            // Initialize the visited nodes
-            vector<int> visited(_numberOfVertices, 0);
+            AE_PHASE("algorithm");
 
-            // While there is a blocking flow in the layered residual graph
-            while (int flow = _sendFlow(_sourceID, 10000, visited))
-                // Add the blocking flow to the maximum flow
-                maxFlow += flow;
-        }
+            // While there is a path from the source to the target in the residual graph
+            while (_BFS())
+            {
+                AE_COUNT("bfs phases", 1);
 
-        // Print the maximum flow
-        cout << maxFlow << endl;
+                // Initialize the current arc of every node
+                vector<int64_t> currentArcs(_graph.offsets(), _graph.offsets() + _numberOfVertices);
 
-        // Initialize the visited nodes
-        vector<bool> visited(_numberOfVertices, false);
+                // Add the blocking flow of the layered residual graph to the maximum flow
+                maxFlow += _sendFlow(currentArcs);
+            }
 
-        // Find the nodes in the computed cut
-        _findNodesInComputedCut(visited, _sourceID);
+            // Find the nodes in the computed cut
+            _findNodesInComputedCut(visited);
+        }
+
+        // Print the maximum flow
+        AE_PHASE("output");
+        ResultWriter out;
+        out << maxFlow << '\n';
 
         // Print the nodes in the computed cut
         for (int i = 0; i < _numberOfVertices; ++i)
             if (visited[i])
-                cout << i + 1 << " ";
+                out << i + 1 << ' ';
     }
 };
 
 /**
  * @brief Main function
  *
- * This function reads a graph from standard input, computes the maximum flow from a source to a target using Dinic's algorithm, and prints the maximum flow and the nodes in the computed cut.
+ * This function reads a graph from the file given as first argument or from standard input, computes the maximum flow from a source to a target using Dinic's algorithm, and prints the maximum flow and the nodes in the computed cut.
+ * By default the input lists both directions of every edge in 2m lines, with --directed it lists m arcs, one per line.
  *
  * @return 0 on successful execution
  */
-int main()
+int main(int argc, char *argv[])
 {
     // Improve the performance of cin
     ios_base::sync_with_stdio(false);
     cin.tie(NULL);
 
-    // Read the number of nodes and edges from standard input
-    int numberOfNodes, numberOfEdges;
-    cin >> numberOfNodes >> numberOfEdges;
+    // Read from the file given as first argument, or from standard input
+    GraphReader file(argc > 1 ? argv[1] : nullptr);
+    if (!file.isOpen())
+    {
+        cerr << "Failed to open the file." << endl;
+        return 1;
+    }
 
-    // Create a graph with the read number of nodes
-    Graph G(numberOfNodes);
+    // "ex5 <file|-> --directed" reads m arcs, one line each, instead of both directions of m edges
+    bool directed = argc > 2 && string(argv[2]) == "--directed";
+    if (argc > 2 + directed)
+    {
+        cerr << "Unknown option " << argv[2 + directed] << "." << endl;
+        return 1;
+    }
 
-    // Read the edges from standard input and add them to the graph
-    for (int line = 0; line < numberOfEdges * 2; ++line)
+    // Read the number of nodes and edges
+    int numberOfNodes, numberOfEdges;
+    file >> numberOfNodes >> numberOfEdges;
+
+    // Read the edges and create a graph with the read number of nodes
+    int64_t numberOfArcs = directed ? numberOfEdges : 2 * static_cast<int64_t>(numberOfEdges);
+    Graph G(file.readGraph(numberOfNodes, numberOfArcs));
+    if (!file)
     {
-        int source, destination, weight;
-        cin >> source >> destination >> weight;
-        G.addEdge(source, destination, weight);
+        cerr << "Invalid graph input." << endl;
+        return 1;
     }
 
-    // Read the source and target from standard input and set them in the graph
-    int source, target;
-    cin >> source >> target;
+    // Read the source and target and set them in the graph
+    int source = 0, target = 0;
+    file >> source >> target;
+    if (source < 1 || source > numberOfNodes || target < 1 || target > numberOfNodes)
+    {
+        cerr << "Invalid source or target." << endl;
+        return 1;
+    }
     G.setSourceAndTarget(source, target);
 
     // Compute the maximum flow from the source to the target using Dinic's algorithm and print the maximum flow and the nodes in the computed cut
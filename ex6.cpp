@@ -3,9 +3,11 @@
 #include <vector>
 #include <iostream>
 #include <algorithm>
-#include <fstream>
 #include <climits>
 
+#include "graph_reader.h"
+#include "instrumentation.h"
+
 using namespace std;
 
 /**
@@ -64,7 +66,7 @@ public:
      *
      * This function adds an edge from the source vertex to the destination vertex with the specified capacity.
      * The edge is added to the adjacency list of the source vertex.
-     * The vertices are decremented by 1 because they are 0-indexed in the adjacency list.
+     * The vertices are expected 0-indexed, the reader already converts them.
      *
      * @param source The source vertex of the edge.
      * @param destination The destination vertex of the edge.
@@ -72,7 +74,7 @@ public:
      */
     void addEdge(int source, int destination, int weight)
     {
-        _edgeList.push_back(Edge(source - 1, destination - 1, weight));
+        _edgeList.push_back(Edge(source, destination, weight));
     }
 
     void bellmannFord()
@@ -86,30 +88,39 @@ public:
         int lastNodeInCycle = -1;
         distances[_numberOfVertices - 1] = 10000;
 
-        // Iterate over all nodes
-        for (int node = 0; node < _numberOfVertices; ++node)
-        {  
-            lastNodeInCycle = -1;
-            // Iterate over all edges
-            for (const Edge &edge : _edgeList)
-            {
-                // Check if the source node distance is less than INT_MAX
-                if (distances[edge.source] < INT_MAX)
+        {
+            AE_PHASE("algorithm");
+
+            // Iterate over all nodes
+            for (int node = 0; node < _numberOfVertices; ++node)
+            {  
+                lastNodeInCycle = -1;
+                AE_COUNT("relaxation passes", 1);
+
+                // Iterate over all edges
+                for (const Edge &edge : _edgeList)
                 {
-                    // Check if the new distance is less than the current distance
-                    if (distances[edge.source] + edge.weight < distances[edge.destination])
+                    // Check if the source node distance is less than INT_MAX
+                    if (distances[edge.source] < INT_MAX)
                     {
-                        // Update the distance
-                        distances[edge.destination] = max(-INT_MAX, distances[edge.source] + edge.weight);
-                        // Update the previous node
-                        previousNode[edge.destination] = edge.source;
-                        // Update the last node in cycle
-                        lastNodeInCycle = edge.destination;
+                        // Check if the new distance is less than the current distance
+                        if (distances[edge.source] + edge.weight < distances[edge.destination])
+                        {
+                            // Update the distance
+                            distances[edge.destination] = max(-INT_MAX, distances[edge.source] + edge.weight);
+                            // Update the previous node
+                            previousNode[edge.destination] = edge.source;
+                            // Update the last node in cycle
+                            lastNodeInCycle = edge.destination;
+                            AE_COUNT("relaxations", 1);
+                        }
                     }
                 }
             }
         }
 
+        AE_PHASE("output");
+
         // Check if a negative cycle was found
         if (lastNodeInCycle == -1)
         {
@@ -146,35 +157,38 @@ public:
  * @brief Main function
  * @return 0 on successful execution
  */
-int main()
+int main(int argc, char *argv[])
 {
     // Improve the performance of cin
     ios_base::sync_with_stdio(false);
     cin.tie(NULL);
 
-    string path = "/Users/jan/Documents/code/AlgorithmEngineering/";
-    ifstream file(path + "example6.txt");
-    if (!file.is_open())
+    // Read from the file given as first argument, or from standard input
+    GraphReader file(argc > 1 ? argv[1] : nullptr);
+    if (!file.isOpen())
     {
         cerr << "Failed to open the file." << endl;
         return 1;
     }
 
-    // Read the number of nodes and edges from standard input
+    // Read the number of nodes and edges
     int numberOfNodes, numberOfEdges;
     file >> numberOfNodes >> numberOfEdges;
 
     // Create a graph with the read number of nodes
     Graph G(numberOfNodes, numberOfEdges);
 
-    // Read the edges from standard input and add them to the graph
-    for (int line = 0; line < numberOfEdges * 2; ++line)
+    // Read the edges and add them to the graph
+    vector<InputEdge> edges = file.readEdges(numberOfNodes, 2 * static_cast<int64_t>(numberOfEdges));
+    if (!file)
     {
-        int source, destination, weight;
-        file >> source >> destination >> weight;
-        G.addEdge(source, destination, weight);
+        cerr << "Invalid graph input." << endl;
+        return 1;
     }
 
+    for (const InputEdge &edge : edges)
+        G.addEdge(edge.source, edge.destination, edge.weight);
+
     G.bellmannFord();
 
     cout << endl;
@@ -4,14 +4,11 @@
 #include <iostream>
 #include <algorithm>
 #include <climits>
-#include <fstream>
 
-using namespace std;
+#include "graph_reader.h"
+#include "instrumentation.h"
 
-struct Edge
-{
-    int source, destination, weight;
-};
+using namespace std;
 
 void disassembleSubtree(int node, const vector<int> &previousNode, vector<bool> &visited, vector<int> &subtree)
 {
@@ -25,15 +22,15 @@ void disassembleSubtree(int node, const vector<int> &previousNode, vector<bool>
     }
 }
 
-int main()
+int main(int argc, char *argv[])
 {
     // Improve the performance of cin
     ios_base::sync_with_stdio(false);
     cin.tie(NULL);
 
-    string path = "/Users/jan/Documents/code/AlgorithmEngineering/";
-    ifstream file(path + "example6.txt");
-    if (!file.is_open())
+    // Read from the file given as first argument, or from standard input
+    GraphReader file(argc > 1 ? argv[1] : nullptr);
+    if (!file.isOpen())
     {
         cerr << "Failed to open the file." << endl;
         return 1;
@@ -42,12 +39,12 @@ int main()
     int numNodes, numEdges;
     file >> numNodes >> numEdges;
 
-    vector<Edge> edges(numEdges);
-    for (int i = 0; i < numEdges; i++)
+    // Read all edges, the reader converts them to 0-indexed vertices
+    vector<InputEdge> edges = file.readEdges(numNodes, numEdges);
+    if (!file)
     {
-        int source, destination, weight;
-        file >> source >> destination >> weight;
-        edges[i] = (Edge){source, destination, weight};
+        cerr << "Invalid graph input." << endl;
+        return 1;
     }
 
     // Initialize vectors
@@ -58,23 +55,29 @@ int main()
     vector<int> previousNode(numNodes, -1);
     int lastNodeInCycle = -1;
 
-    for (int i = 0; i < numNodes; ++i)
     {
-        lastNodeInCycle = -1;
-        for (const Edge &edge : edges)
+        AE_PHASE("algorithm");
+        for (int i = 0; i < numNodes; ++i)
         {
-            if (distances[edge.source] < INT_MAX)
+            lastNodeInCycle = -1;
+            AE_COUNT("relaxation passes", 1);
+            for (const InputEdge &edge : edges)
             {
-                if (distances[edge.source] + edge.weight < distances[edge.destination])
+                if (distances[edge.source] < INT_MAX)
                 {
-                    distances[edge.destination] = max(-INT_MAX, distances[edge.source] + edge.weight);
-                    previousNode[edge.destination] = edge.source;
-                    lastNodeInCycle = edge.destination;
+                    if (distances[edge.source] + edge.weight < distances[edge.destination])
+                    {
+                        distances[edge.destination] = max(-INT_MAX, distances[edge.source] + edge.weight);
+                        previousNode[edge.destination] = edge.source;
+                        lastNodeInCycle = edge.destination;
+                        AE_COUNT("relaxations", 1);
+                    }
                 }
             }
         }
     }
 
+    AE_PHASE("output");
     if (lastNodeInCycle == -1)
     {
         cout << "No negative cycle found.\n";
@@ -102,8 +105,8 @@ int main()
 
         cout << cycle.size() << '\n';
         for (int node : cycle)
-            cout << node << ' ';
-        cout << cycle[0] << endl;
+            cout << node + 1 << ' ';
+        cout << cycle[0] + 1 << endl;
     }
     return 0;
 }
\ No newline at end of file
@@ -3,10 +3,13 @@
 #include <vector>
 #include <iostream>
 #include <algorithm>
-#include <fstream>
 #include <climits>
 #include <random>
 
+#include "graph_reader.h"
+#include "instrumentation.h"
+#include "result_writer.h"
+
 using namespace std;
 
 /**
@@ -89,7 +92,7 @@ public:
      *
      * This function adds an edge from the source vertex to the destination vertex with the specified weight.
      * The edge is added to the adjacency list of the source vertex.
-     * The vertices are decremented by 1 because they are 0-indexed in the adjacency list.
+     * The vertices are expected 0-indexed, the reader already converts them.
      *
      * @param source The source vertex of the edge.
      * @param destination The destination vertex of the edge.
@@ -98,7 +101,7 @@ public:
     void addEdge(int source, int destination, int weight)
     {
         if (source < destination)
-            _edgeList.push_back(Edge(source - 1, destination - 1, weight));
+            _edgeList.push_back(Edge(source, destination, weight));
     }
 
     int computeMaximumWeightMatching(vector<Edge> &edgeList)
@@ -126,46 +129,53 @@ public:
         int highestScore = 0;
         vector<Edge> highestMatching;
 
-        // Without sorting
-        int currentWeight = computeMaximumWeightMatching(_edgeList);
-        if (currentWeight > highestScore)
         {
-            highestScore = currentWeight;
-            highestMatching = _matching;
-        }
-        
-        _matching.clear();
+            AE_PHASE("algorithm");
 
-        // With max sorting
-        sort(_edgeList.begin(), _edgeList.end());
-        currentWeight = computeMaximumWeightMatching(_edgeList);
-        if (currentWeight > highestScore)
-        {
-            highestScore = currentWeight;
-            highestMatching = _matching;
-        }
+            // Without sorting
+            int currentWeight = computeMaximumWeightMatching(_edgeList);
+            if (currentWeight > highestScore)
+            {
+                highestScore = currentWeight;
+                highestMatching = _matching;
+            }
 
-        // Random sort
-        for (int i = 0; i < 250; ++i)
-        {
             _matching.clear();
-            random_device rd;
-            mt19937 g(rd());
-            shuffle(_edgeList.begin(), _edgeList.end(), g);
+
+            // With max sorting
+            sort(_edgeList.begin(), _edgeList.end());
             currentWeight = computeMaximumWeightMatching(_edgeList);
             if (currentWeight > highestScore)
             {
                 highestScore = currentWeight;
                 highestMatching = _matching;
             }
-        }
 
+            // Random sort
+            for (int i = 0; i < 250; ++i)
+            {
+                _matching.clear();
+                random_device rd;
+                mt19937 g(rd());
+                shuffle(_edgeList.begin(), _edgeList.end(), g);
+                AE_COUNT("shuffles", 1);
+                currentWeight = computeMaximumWeightMatching(_edgeList);
+                if (currentWeight > highestScore)
+                {
+                    highestScore = currentWeight;
+                    highestMatching = _matching;
+                }
+            }
+        }
 
-        cout << highestMatching.size() << endl;
-        cout << highestScore << endl;
+        AE_PHASE("output");
+        ResultWriter out;
+        out << highestMatching.size() << '\n';
+        out << highestScore << '\n';
 
         for (const Edge &edge : highestMatching)
-            cout << edge.source + 1 << " " << edge.destination + 1 << endl;
+            out << edge.source + 1 << ' ' << edge.destination + 1 << '\n';
+        out << '\n';
     }
 };
 
@@ -173,38 +183,39 @@ public:
  * @brief Main function
  * @return 0 on successful execution
  */
-int main()
+int main(int argc, char *argv[])
 {
     // Improve the performance of cin
     ios_base::sync_with_stdio(false);
     cin.tie(NULL);
 
-    string path = "/Users/jan/Documents/code/AlgorithmEngineering/";
-    ifstream file(path + "example7.txt");
-    if (!file.is_open())
+    // Read from the file given as first argument, or from standard input
+    GraphReader file(argc > 1 ? argv[1] : nullptr);
+    if (!file.isOpen())
     {
         cerr << "Failed to open the file." << endl;
         return 1;
     }
 
-    // Read the number of nodes and edges from standard input
+    // Read the number of nodes and edges
     int numberOfNodes, numberOfEdges;
     file >> numberOfNodes >> numberOfEdges;
 
     // Create a graph with the read number of nodes
     Graph G(numberOfNodes, numberOfEdges);
 
-    // Read the edges from standard input and add them to the graph
-    for (int line = 0; line < numberOfEdges * 2; ++line)
+    // Read the edges and add them to the graph
+    vector<InputEdge> edges = file.readEdges(numberOfNodes, 2 * static_cast<int64_t>(numberOfEdges));
+    if (!file)
     {
-        int source, destination, weight;
-        file >> source >> destination >> weight;
-        G.addEdge(source, destination, weight);
+        cerr << "Invalid graph input." << endl;
+        return 1;
     }
 
-    G.compareMatchings();
+    for (const InputEdge &edge : edges)
+        G.addEdge(edge.source, edge.destination, edge.weight);
 
-    cout << endl;
+    G.compareMatchings();
 
     // Return 0 on successful execution
     return 0;
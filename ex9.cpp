@@ -2,68 +2,41 @@
 #include <iostream>
 #include <queue>
 #include <unordered_set>
-#include <fstream>
 #include <algorithm>
 
-using namespace std;
+#include "csr_graph.h"
+#include "graph_reader.h"
+#include "instrumentation.h"
+#include "result_writer.h"
+#include "vertex_order.h"
 
-/**
- * @struct Edge
- * @brief Structure to represent an edge in the graph.
- * @param source The source vertex of the edge.
- * @param destination The destination vertex of the edge.
- * @param weight The weight of this edge.
- */
-struct Edge
-{
-    int source;      // Source vertex of the edge
-    int destination; // Destination vertex of the edge
-    int weight;      // Weight of this edge
-    int color;       // Color of this edge
-
-    /**
-     * @brief Constructor for Edge.
-     * @param src The source vertex of the edge.
-     * @param dest The destination vertex of the edge.
-     * @param w The weight of the edge.
-     */
-    Edge(int src, int dest, int w) : source(src), destination(dest), weight(w), color(-1) {}
-};
+using namespace std;
 
 /**
  * @class Graph
  * @brief Class to represent a graph.
  * @param _numberOfVertices The number of vertices in the graph.
- * @param _adjacencyList The adjacency list to represent the graph.
- * @param _edgeList The list of edges in the graph.
+ * @param _graph The CSR structure of the graph.
+ * @param _colors The color of every arc of the graph.
  */
 class Graph
 {
 private:
     int _numberOfVertices; // Number of vertices in the graph
     int _numberOfEdges;
-    vector<vector<Edge> > _adjacencyList; // Adjacency list to represent the graph
+    CSRGraph _graph;       // CSR structure of the graph
+    vector<int> _colors;   // Color of every arc, -1 if uncolored
     vector<bool> _visited; //penis hihihi
     int _highestColor = 0;
 
     void _coloring()
     {
-        // Create a vector of pairs (degree, vertexID) for all vertices
-        vector<pair<int, int> > degrees(_numberOfVertices);
-        for (int i = 0; i < _numberOfVertices; i++)
-        {
-            degrees[i] = make_pair(_adjacencyList[i].size(), i);
-        }
-
-        // Sort the vertices in descending order of their degrees
-        sort(degrees.begin(), degrees.end(), greater<pair<int, int> >());
+        // Sort the vertices in descending order of their degrees, ties by descending ID
+        vector<int> order = orderByDegree(_graph, true);
 
         // Color the vertices in the order determined by their degrees
-        for (const auto &degree : degrees)
-        {
-            int currentNodeID = degree.second;
+        for (int currentNodeID : order)
             _colorVertex(currentNodeID);
-        }
     }
 
     void _colorVertex(int currentNodeID)
@@ -76,9 +49,9 @@ private:
         unordered_set<int> colored;
 
         // Collect colors of all adjacent edges
-        for (const Edge &e : _adjacencyList[currentNodeID])
-            if (e.color != -1)
-                colored.insert(e.color);
+        for (int64_t arc = _graph.firstArc(currentNodeID); arc < _graph.lastArc(currentNodeID); ++arc)
+            if (_colors[arc] != -1)
+                colored.insert(_colors[arc]);
 
         // Find the smallest color that's not used by adjacent edges
         int c = 0;
@@ -86,20 +59,21 @@ private:
             c++;
 
         // Color all edges from currentNodeID
-        for (Edge &edge : _adjacencyList[currentNodeID])
+        for (int64_t arc = _graph.firstArc(currentNodeID); arc < _graph.lastArc(currentNodeID); ++arc)
         {
-            if (edge.color == -1)
+            if (_colors[arc] == -1)
             {
-                edge.color = c;
+                _colors[arc] = c;
                 if (_highestColor < c)
                     _highestColor = c;
 
                 // Color the reverse edge as well
-                for (Edge &revEdge : _adjacencyList[edge.destination])
+                int destination = _graph.target(arc);
+                for (int64_t reverseArc = _graph.firstArc(destination); reverseArc < _graph.lastArc(destination); ++reverseArc)
                 {
-                    if (revEdge.destination == currentNodeID && revEdge.source == edge.destination && revEdge.color == -1)
+                    if (_graph.target(reverseArc) == currentNodeID && _colors[reverseArc] == -1)
                     {
-                        revEdge.color = c;
+                        _colors[reverseArc] = c;
                         break;
                     }
                 }
@@ -111,43 +85,32 @@ public:
     /**
      * @brief Constructor for Graph.
      *
-     * This constructor initializes the graph with the specified number of vertices.
-     * It resizes the adjacency list to hold the edges for each vertex and reserves space for the node list.
-     * It also creates a node for each vertex and adds it to the node list.
+     * This constructor takes over the CSR structure of the graph and marks every arc as uncolored.
      *
-     * @param vertices The number of vertices in the graph.
+     * @param graph The CSR structure of the graph.
      */
-    Graph(int vertices, int edges) : _numberOfVertices(vertices), _numberOfEdges(edges)
+    Graph(CSRGraph graph) : _numberOfVertices(graph.numberOfVertices()), _graph(move(graph))
     {
-        _adjacencyList.resize(_numberOfVertices);
+        _numberOfEdges = static_cast<int>(_graph.numberOfArcs() / 2);
+        _colors.assign(_graph.numberOfArcs(), -1);
         _visited.resize(_numberOfVertices);
     }
 
-    /**
-     * @brief Function to add an edge to the graph.
-     *
-     * This function adds an edge from the source vertex to the destination vertex with the specified weight.
-     * The edge is added to the adjacency list of the source vertex.
-     * The vertices are decremented by 1 because they are 0-indexed in the adjacency list.
-     *
-     * @param source The source vertex of the edge.
-     * @param destination The destination vertex of the edge.
-     * @param weight The weight of the edge.
-     */
-    void addEdge(int source, int destination, int weight)
-    {
-        _adjacencyList[source - 1].push_back(Edge(source - 1, destination - 1, weight));
-    }
-
     void edgeColoring()
     {
-        _coloring();
+        {
+            AE_PHASE("algorithm");
+            _coloring();
+        }
 
-        cout << _highestColor + 1 << "\n";
+        AE_PHASE("output");
+        ResultWriter out;
+        out << _highestColor + 1 << '\n';
         for (int nodeID = 0; nodeID < _numberOfVertices; ++nodeID)
-            for (const Edge &edge : _adjacencyList[nodeID])
-                if (edge.source < edge.destination)
-                    cout << edge.source + 1 << " " << edge.destination + 1 << " " << edge.color + 1 << "\n";
+            for (int64_t arc = _graph.firstArc(nodeID); arc < _graph.lastArc(nodeID); ++arc)
+                if (nodeID < _graph.target(arc))
+                    out << nodeID + 1 << ' ' << _graph.target(arc) + 1 << ' ' << _colors[arc] + 1 << '\n';
+        out << '\n';
     }
 };
 
@@ -155,39 +118,34 @@ public:
  * @brief Main function
  * @return 0 on successful execution
  */
-int main()
+int main(int argc, char *argv[])
 {
     // Improve the performance of cin
     ios_base::sync_with_stdio(false);
     cin.tie(NULL);
 
-    string path = "/Users/jan/Documents/code/ae/";
-    ifstream file(path + "example9.txt");
-    if (!file.is_open())
+    // Read from the file given as first argument, or from standard input
+    GraphReader file(argc > 1 ? argv[1] : nullptr);
+    if (!file.isOpen())
     {
         cerr << "Failed to open the file." << endl;
         return 1;
     }
 
-    // Read the number of nodes and edges from standard input
+    // Read the number of nodes and edges
     int numberOfNodes, numberOfEdges;
     file >> numberOfNodes >> numberOfEdges;
 
-    // Create a graph with the read number of nodes
-    Graph G(numberOfNodes, numberOfEdges);
-
-    // Read the edges from standard input and add them to the graph
-    for (int line = 0; line < numberOfEdges * 2; ++line)
+    // Read the edges and create a graph with the read number of nodes
+    Graph G(file.readGraph(numberOfNodes, 2 * static_cast<int64_t>(numberOfEdges)));
+    if (!file)
     {
-        int source, destination, weight;
-        file >> source >> destination >> weight;
-        G.addEdge(source, destination, weight);
+        cerr << "Invalid graph input." << endl;
+        return 1;
     }
 
     G.edgeColoring();
 
-    cout << '\n';
-
     // Return 0 on successful execution
     return 0;
 }
@@ -3,6 +3,10 @@
 #include <vector>
 #include <iostream>
 #include <algorithm>
+
+#include "graph_reader.h"
+#include "instrumentation.h"
+
 using namespace std;
 
 struct Edge
@@ -12,52 +16,69 @@ struct Edge
     int color = 0;
 };
 
-int main()
+int main(int argc, char *argv[])
 {
+    // Read from the file given as first argument, or from standard input
+    GraphReader file(argc > 1 ? argv[1] : nullptr);
+    if (!file.isOpen())
+    {
+        cerr << "Failed to open the file." << endl;
+        return 1;
+    }
+
     int numNodes, numEdges;
-    cin >> numNodes >> numEdges;
+    file >> numNodes >> numEdges;
     vector<vector<Edge>> neighbours(numNodes);
     vector<vector<int>> usedColors(numNodes);
     int maxColors = 0;
 
-    for (int i = 0; i < numEdges * 2; i++)
+    vector<InputEdge> edges = file.readEdges(numNodes, 2 * static_cast<int64_t>(numEdges));
+    if (!file)
+    {
+        cerr << "Invalid graph input." << endl;
+        return 1;
+    }
+
+    for (const InputEdge &edge : edges)
     {
         Edge e;
-        int u, v, w;
-        cin >> u >> v >> w;
-        e.u = u - 1;
-        e.v = v - 1;
+        e.u = edge.source;
+        e.v = edge.destination;
         if (e.u < e.v)
         {
             neighbours[e.u].push_back(e);
         }
     }
 
-    for (int i = 0; i < neighbours.size(); i++)
     {
-        int color = 1;
-        for (int j = 0; j < neighbours[i].size(); j++)
+        AE_PHASE("algorithm");
+        for (int i = 0; i < neighbours.size(); i++)
         {
-            bool colorUsed = true;
-            while (colorUsed)
+            int color = 1;
+            for (int j = 0; j < neighbours[i].size(); j++)
             {
-                colorUsed = false;
-                if ((find(usedColors[i].begin(), usedColors[i].end(), color) != usedColors[i].end()) || (find(usedColors[neighbours[i][j].v].begin(), usedColors[neighbours[i][j].v].end(), color) != usedColors[neighbours[i][j].v].end()))
+                bool colorUsed = true;
+                while (colorUsed)
                 {
-                    color++;
-                    if (maxColors < color)
+                    colorUsed = false;
+                    if ((find(usedColors[i].begin(), usedColors[i].end(), color) != usedColors[i].end()) || (find(usedColors[neighbours[i][j].v].begin(), usedColors[neighbours[i][j].v].end(), color) != usedColors[neighbours[i][j].v].end()))
                     {
-                        maxColors = color;
+                        color++;
+                        if (maxColors < color)
+                        {
+                            maxColors = color;
+                        }
+                        colorUsed = true;
                     }
-                    colorUsed = true;
                 }
+                neighbours[i][j].color = color;
+                usedColors[i].push_back(color);
+                usedColors[neighbours[i][j].v].push_back(color);
             }
-            neighbours[i][j].color = color;
-            usedColors[i].push_back(color);
-            usedColors[neighbours[i][j].v].push_back(color);
         }
     }
 
+    AE_PHASE("output");
     cout << maxColors << endl;
     for (int i = 0; i < numNodes; i++)
     {
@@ -0,0 +1,536 @@
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "result_writer.h"
+
+using namespace std;
+
+/**
+ * @struct Options
+ * @brief Command line options of the generator.
+ */
+struct Options
+{
+    string family;                  // Graph family
+    long long vertices = 0;         // Number of vertices (-n)
+    long long edges = 0;            // Number of edges (-m)
+    long long rows = 0;             // Grid rows
+    long long columns = 0;          // Grid columns
+    long long layers = 1;           // Grid layers (3D grids)
+    double radius = 0;              // Radius of random geometric graphs, 0 picks average degree ~8
+    double rmat[3] = {0.57, 0.19, 0.19}; // R-MAT quadrant probabilities a, b, c
+    long long cycleLength = 3;      // Length of the planted negative cycle
+    long long minWeight = 1;        // Smallest edge weight
+    long long maxWeight = 100;      // Largest edge weight
+    unsigned long long seed = 1;    // Random seed
+    string output;                  // Output file, empty for standard output
+    long long partitionBlocks = 0;  // Append a random partition with this many blocks (ex1_2)
+    bool vertexWeights = false;     // Append vertex weights (ex4)
+    long long minVertexWeight = 1;  // Smallest vertex weight
+    long long maxVertexWeight = 10; // Largest vertex weight
+    bool sourceTarget = false;      // Append a source and target line (ex5)
+    bool pair = false;              // Append a vertex pair line (ex2_1)
+};
+
+/**
+ * @brief Prints how to call the generator.
+ */
+void printUsage()
+{
+    cerr << "usage: graph_generator <family> [options]" << endl
+         << endl
+         << "families (undirected ones write both directions of every edge):" << endl
+         << "  rmat      -n N -m M [--rmat a,b,c]   R-MAT / Kronecker graph, may contain parallel edges" << endl
+         << "  er        -n N -m M                  Erdos-Renyi G(n, m), may contain parallel edges" << endl
+         << "  grid2d    --rows R --cols C          2D grid" << endl
+         << "  grid3d    --rows R --cols C --layers L  3D grid" << endl
+         << "  rgg       -n N [--radius r]          random geometric graph in the unit square" << endl
+         << "  dag       -n N -m M                  directed acyclic graph, one line per arc (ex8)" << endl
+         << "  star      -n N                       vertex 1 joined to all others, with --vertex-weights every" << endl
+         << "                                       leaf weighs MIN and the center one less than all leaves (ex4)" << endl
+         << "  negcycle  -n N -m M [--cycle L]      directed graph with a planted negative cycle" << endl
+         << "                                       reachable from vertex n, one line per arc (ex6)" << endl
+         << endl
+         << "options:" << endl
+         << "  --weights MIN:MAX          edge weights, uniform (default 1:100)" << endl
+         << "  --seed S                   random seed (default 1)" << endl
+         << "  -o FILE                    output file (default standard output)" << endl
+         << "  --partition K              append a random K-way partition, header becomes \"n m K\" (ex1_2)" << endl
+         << "  --vertex-weights MIN:MAX   append one vertex weight per line (ex4)" << endl
+         << "  --source-target            append the line \"1 n\" (ex5)" << endl
+         << "  --pair                     append the line \"1 2\" (ex2_1)" << endl;
+}
+
+/**
+ * @brief Parses "MIN:MAX".
+ */
+bool parseRange(const char *text, long long &minimum, long long &maximum)
+{
+    return sscanf(text, "%lld:%lld", &minimum, &maximum) == 2 && minimum <= maximum;
+}
+
+/**
+ * @brief Parses the command line into options.
+ * @return False on invalid arguments.
+ */
+bool parseOptions(int argc, char *argv[], Options &options)
+{
+    if (argc < 2)
+        return false;
+
+    options.family = argv[1];
+    for (int i = 2; i < argc; ++i)
+    {
+        string option = argv[i];
+        bool hasValue = i + 1 < argc;
+        const char *value = hasValue ? argv[i + 1] : "";
+
+        if (option == "-n" && hasValue)
+            options.vertices = atoll(value);
+        else if (option == "-m" && hasValue)
+            options.edges = atoll(value);
+        else if (option == "--rows" && hasValue)
+            options.rows = atoll(value);
+        else if (option == "--cols" && hasValue)
+            options.columns = atoll(value);
+        else if (option == "--layers" && hasValue)
+            options.layers = atoll(value);
+        else if (option == "--radius" && hasValue)
+            options.radius = atof(value);
+        else if (option == "--rmat" && hasValue)
+        {
+            if (sscanf(value, "%lf,%lf,%lf", &options.rmat[0], &options.rmat[1], &options.rmat[2]) != 3)
+                return false;
+        }
+        else if (option == "--cycle" && hasValue)
+            options.cycleLength = atoll(value);
+        else if (option == "--weights" && hasValue)
+        {
+            if (!parseRange(value, options.minWeight, options.maxWeight))
+                return false;
+        }
+        else if (option == "--seed" && hasValue)
+            options.seed = strtoull(value, nullptr, 10);
+        else if (option == "-o" && hasValue)
+            options.output = value;
+        else if (option == "--partition" && hasValue)
+            options.partitionBlocks = atoll(value);
+        else if (option == "--vertex-weights" && hasValue)
+        {
+            options.vertexWeights = true;
+            if (!parseRange(value, options.minVertexWeight, options.maxVertexWeight))
+                return false;
+        }
+        else if (option == "--source-target")
+        {
+            options.sourceTarget = true;
+            continue;
+        }
+        else if (option == "--pair")
+        {
+            options.pair = true;
+            continue;
+        }
+        else
+            return false;
+
+        ++i; // Skip the value
+    }
+
+    return true;
+}
+
+/**
+ * @class Generator
+ * @brief Streams one graph family in the "n m" + edge lines format.
+ *
+ * Edges are written as soon as they are drawn, so memory stays bounded by the vertex count
+ * (random geometric graphs and DAGs keep per-vertex data) no matter how many edges are written.
+ */
+class Generator
+{
+private:
+    const Options &_options; // Command line options
+    ResultWriter &_writer;   // Output
+    mt19937_64 _random;      // Random number generator
+
+    /**
+     * @brief Writes integers separated by spaces and terminated by a newline.
+     */
+    void _line(initializer_list<long long> values)
+    {
+        const char *separator = "";
+        for (long long value : values)
+        {
+            _writer << separator << value;
+            separator = " ";
+        }
+        _writer << '\n';
+    }
+
+    long long _weight()
+    {
+        return uniform_int_distribution<long long>(_options.minWeight, _options.maxWeight)(_random);
+    }
+
+    long long _vertex(long long vertices)
+    {
+        return uniform_int_distribution<long long>(0, vertices - 1)(_random);
+    }
+
+    /**
+     * @brief Writes both directions of an undirected edge, vertices are 0-indexed.
+     */
+    void _undirected(long long u, long long v, long long weight)
+    {
+        _line({u + 1, v + 1, weight});
+        _line({v + 1, u + 1, weight});
+    }
+
+    /**
+     * @brief Writes the header line, with the number of partition blocks if requested.
+     */
+    void _header(long long vertices, long long edges)
+    {
+        if (_options.partitionBlocks > 0)
+            _line({vertices, edges, _options.partitionBlocks});
+        else
+            _line({vertices, edges});
+    }
+
+    /**
+     * @brief Draws one R-MAT edge by descending the adjacency matrix quadrants.
+     */
+    void _rmatEdge(int scale, long long &u, long long &v)
+    {
+        uniform_real_distribution<double> uniform(0.0, 1.0);
+        double a = _options.rmat[0], b = _options.rmat[1], c = _options.rmat[2];
+        u = 0;
+        v = 0;
+        for (int level = 0; level < scale; ++level)
+        {
+            double r = uniform(_random);
+            int row = r >= a + b;
+            int column = (r >= a && r < a + b) || r >= a + b + c;
+            u = (u << 1) | row;
+            v = (v << 1) | column;
+        }
+    }
+
+    void _rmat()
+    {
+        long long n = _options.vertices;
+        int scale = 0;
+        while ((1LL << scale) < n)
+            ++scale;
+
+        _header(n, _options.edges);
+        for (long long edge = 0; edge < _options.edges;)
+        {
+            long long u, v;
+            _rmatEdge(scale, u, v);
+            if (u >= n || v >= n || u == v) // Outside the vertex range or a self-loop, draw again
+                continue;
+            _undirected(u, v, _weight());
+            ++edge;
+        }
+    }
+
+    void _erdosRenyi()
+    {
+        long long n = _options.vertices;
+        _header(n, _options.edges);
+        for (long long edge = 0; edge < _options.edges;)
+        {
+            long long u = _vertex(n), v = _vertex(n);
+            if (u == v)
+                continue;
+            _undirected(u, v, _weight());
+            ++edge;
+        }
+    }
+
+    void _grid(long long layers)
+    {
+        long long rows = _options.rows, columns = _options.columns;
+        long long n = rows * columns * layers;
+        long long m = layers * (rows * (columns - 1) + columns * (rows - 1)) + (layers - 1) * rows * columns;
+        _header(n, m);
+
+        for (long long layer = 0; layer < layers; ++layer)
+            for (long long row = 0; row < rows; ++row)
+                for (long long column = 0; column < columns; ++column)
+                {
+                    long long vertex = (layer * rows + row) * columns + column;
+                    if (column + 1 < columns)
+                        _undirected(vertex, vertex + 1, _weight());
+                    if (row + 1 < rows)
+                        _undirected(vertex, vertex + columns, _weight());
+                    if (layer + 1 < layers)
+                        _undirected(vertex, vertex + rows * columns, _weight());
+                }
+    }
+
+    void _randomGeometric()
+    {
+        long long n = _options.vertices;
+        double radius = _options.radius > 0 ? _options.radius : sqrt(8.0 / (M_PI * max(1LL, n)));
+
+        // Place the points and sort them into square cells of side radius with a counting sort
+        uniform_real_distribution<double> uniform(0.0, 1.0);
+        vector<double> x(n), y(n);
+        for (long long vertex = 0; vertex < n; ++vertex)
+        {
+            x[vertex] = uniform(_random);
+            y[vertex] = uniform(_random);
+        }
+
+        long long cellsPerSide = max(1LL, min(static_cast<long long>(1.0 / radius), 1LL << 15));
+        auto cellOf = [&](long long vertex)
+        {
+            long long cx = min(cellsPerSide - 1, static_cast<long long>(x[vertex] * cellsPerSide));
+            long long cy = min(cellsPerSide - 1, static_cast<long long>(y[vertex] * cellsPerSide));
+            return cy * cellsPerSide + cx;
+        };
+
+        vector<long long> cellStart(cellsPerSide * cellsPerSide + 1, 0);
+        for (long long vertex = 0; vertex < n; ++vertex)
+            cellStart[cellOf(vertex) + 1]++;
+        partial_sum(cellStart.begin(), cellStart.end(), cellStart.begin());
+        vector<long long> cellVertices(n);
+        vector<long long> position(cellStart.begin(), cellStart.end() - 1);
+        for (long long vertex = 0; vertex < n; ++vertex)
+            cellVertices[position[cellOf(vertex)]++] = vertex;
+
+        // Visits every pair closer than radius once, first to count, then to write
+        auto forEachPair = [&](auto visit)
+        {
+            double squaredRadius = radius * radius;
+            for (long long cy = 0; cy < cellsPerSide; ++cy)
+                for (long long cx = 0; cx < cellsPerSide; ++cx)
+                {
+                    long long cell = cy * cellsPerSide + cx;
+                    // The cell itself and the neighboring cells right and below, so no pair is visited twice
+                    const long long neighborX[5] = {0, 1, -1, 0, 1};
+                    const long long neighborY[5] = {0, 0, 1, 1, 1};
+                    for (int neighbor = 0; neighbor < 5; ++neighbor)
+                    {
+                        long long ox = cx + neighborX[neighbor], oy = cy + neighborY[neighbor];
+                        if (ox < 0 || ox >= cellsPerSide || oy >= cellsPerSide)
+                            continue;
+                        long long other = oy * cellsPerSide + ox;
+                        for (long long i = cellStart[cell]; i < cellStart[cell + 1]; ++i)
+                            for (long long j = (other == cell ? i + 1 : cellStart[other]); j < cellStart[other + 1]; ++j)
+                            {
+                                long long u = cellVertices[i], v = cellVertices[j];
+                                double dx = x[u] - x[v], dy = y[u] - y[v];
+                                if (dx * dx + dy * dy <= squaredRadius)
+                                    visit(u, v);
+                            }
+                    }
+                }
+        };
+
+        long long m = 0;
+        forEachPair([&](long long, long long) { ++m; });
+        _header(n, m);
+        forEachPair([&](long long u, long long v) { _undirected(u, v, _weight()); });
+    }
+
+    void _star()
+    {
+        long long n = _options.vertices;
+        _header(n, n - 1);
+        for (long long leaf = 1; leaf < n; ++leaf)
+            _undirected(0, leaf, _weight());
+    }
+
+    void _dag()
+    {
+        long long n = _options.vertices;
+
+        // Arcs always point forward in a random topological order
+        vector<long long> order(n);
+        iota(order.begin(), order.end(), 0);
+        shuffle(order.begin(), order.end(), _random);
+
+        _header(n, _options.edges);
+        for (long long arc = 0; arc < _options.edges;)
+        {
+            long long a = _vertex(n), b = _vertex(n);
+            if (a == b)
+                continue;
+            if (a > b)
+                swap(a, b);
+            _line({order[a] + 1, order[b] + 1, _weight()});
+            ++arc;
+        }
+    }
+
+    void _negativeCycle()
+    {
+        long long n = _options.vertices;
+        long long cycleLength = min(max(2LL, _options.cycleLength), n - 1);
+        long long backboneLength = n - 1;
+        long long randomArcs = max(0LL, _options.edges - backboneLength - cycleLength);
+
+        // Chain from vertex n through all other vertices, so the cycle is reachable from the
+        // Bellman-Ford start vertex of ex6
+        vector<long long> order(n - 1);
+        iota(order.begin(), order.end(), 0);
+        shuffle(order.begin(), order.end(), _random);
+
+        _header(n, backboneLength + cycleLength + randomArcs);
+
+        long long previous = n - 1;
+        for (long long vertex : order)
+        {
+            _line({previous + 1, vertex + 1, _weight()});
+            previous = vertex;
+        }
+
+        // Planted cycle over the first vertices of the chain, total weight -1
+        for (long long i = 0; i < cycleLength; ++i)
+        {
+            long long from = order[i], to = order[(i + 1) % cycleLength];
+            long long weight = (i + 1 < cycleLength) ? 0 : -1;
+            _line({from + 1, to + 1, weight});
+        }
+
+        // Random arcs with non-negative weights
+        for (long long arc = 0; arc < randomArcs;)
+        {
+            long long u = _vertex(n), v = _vertex(n);
+            if (u == v)
+                continue;
+            _line({u + 1, v + 1, max(0LL, _weight())});
+            ++arc;
+        }
+    }
+
+    /**
+     * @brief Appends the data some exercises expect after the edge lines.
+     */
+    void _trailer(long long n)
+    {
+        if (_options.partitionBlocks > 0)
+            for (long long vertex = 0; vertex < n; ++vertex)
+                _line({_vertex(_options.partitionBlocks)});
+
+        if (_options.vertexWeights && _options.family == "star")
+        {
+            // The center is lighter than its leaves together, so the leaves are folded into it one by one
+            _line({(n - 1) * _options.minVertexWeight - 1});
+            for (long long vertex = 1; vertex < n; ++vertex)
+                _line({_options.minVertexWeight});
+        }
+        else if (_options.vertexWeights)
+        {
+            uniform_int_distribution<long long> vertexWeight(_options.minVertexWeight, _options.maxVertexWeight);
+            for (long long vertex = 0; vertex < n; ++vertex)
+                _line({vertexWeight(_random)});
+        }
+
+        if (_options.sourceTarget)
+            _line({1, n});
+
+        if (_options.pair)
+            _line({1, min(2LL, n)});
+    }
+
+public:
+    Generator(const Options &options, ResultWriter &writer) : _options(options), _writer(writer), _random(options.seed) {}
+
+    /**
+     * @brief Writes the graph of the selected family.
+     * @return False if the family or its parameters are invalid.
+     */
+    bool generate()
+    {
+        const string &family = _options.family;
+        long long n = _options.vertices;
+
+        if ((family == "rmat" || family == "er" || family == "dag") && n >= 2 && _options.edges >= 0)
+            family == "rmat" ? _rmat() : family == "er" ? _erdosRenyi() : _dag();
+        else if (family == "negcycle" && n >= 3)
+            _negativeCycle();
+        else if ((family == "grid2d" || family == "grid3d") && _options.rows > 0 && _options.columns > 0)
+        {
+            long long layers = family == "grid3d" ? max(1LL, _options.layers) : 1;
+            n = _options.rows * _options.columns * layers;
+            _grid(layers);
+        }
+        else if (family == "rgg" && n >= 1)
+            _randomGeometric();
+        else if (family == "star" && n >= 3)
+            _star();
+        else
+            return false;
+
+        _trailer(n);
+        return true;
+    }
+};
+
+/**
+ * @brief Main function
+ *
+ * This function writes a synthetic graph of the selected family in the input format of the exercises.
+ *
+ * @return 0 on successful execution
+ */
+int main(int argc, char *argv[])
+{
+    Options options;
+    if (!parseOptions(argc, argv, options))
+    {
+        printUsage();
+        return 1;
+    }
+
+    int descriptor = options.output.empty() ? STDOUT_FILENO : open(options.output.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (descriptor < 0)
+    {
+        cerr << "Failed to open the file." << endl;
+        return 1;
+    }
+
+    bool generated, written;
+    {
+        ResultWriter writer(descriptor, false);
+        Generator generator(options, writer);
+        generated = generator.generate();
+        writer.flush();
+        written = writer.good();
+    }
+
+    if (descriptor != STDOUT_FILENO)
+        close(descriptor);
+
+    if (!written)
+    {
+        cerr << "Failed to write the file." << endl;
+        return 1;
+    }
+
+    if (!generated)
+    {
+        printUsage();
+        return 1;
+    }
+
+    return 0;
+}
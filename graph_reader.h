@@ -0,0 +1,611 @@
+#ifndef GRAPH_READER_H
+#define GRAPH_READER_H
+
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "csr_graph.h"
+#include "graph_snapshot.h"
+#include "instrumentation.h"
+#include "parallel.h"
+
+/**
+ * @brief Parses a signed decimal integer, skipping leading blanks on the same line.
+ * @param current The position to start parsing at.
+ * @param end The end of the input.
+ * @param value The parsed value.
+ * @return The position after the last digit.
+ */
+inline const char *parseInteger(const char *current, const char *end, long long &value)
+{
+    while (current < end && (*current == ' ' || *current == '\t' || *current == '\r'))
+        ++current;
+
+    bool negative = current < end && *current == '-';
+    current += negative;
+
+    long long result = 0;
+    while (current < end && static_cast<unsigned>(*current - '0') < 10)
+        result = result * 10 + (*current++ - '0');
+
+    value = negative ? -result : result;
+    return current;
+}
+
+/**
+ * @class GraphReader
+ * @brief Zero-copy reader for the "n m" header plus edge line input format.
+ *
+ * Regular files (also when redirected to standard input) are memory mapped. Pipes are streamed through
+ * a fixed-size window instead, so their memory use does not grow with the input; a line cut off at the
+ * end of the window is carried over into the next one. The edge lines are split into chunks at line
+ * boundaries and parsed on all threads straight into the output arrays. Everything around the edge
+ * lines (header, partitions, source and target, vertex weights) is read sequentially with operator>>
+ * like an ifstream.
+ *
+ * Binary snapshots written by graph_convert are recognized by their magic number. Their CSR arrays
+ * are handed out directly from the mapping, and the sequential cursor runs over the stored text, so
+ * the tools read snapshots and text inputs with the same code.
+ */
+class GraphReader
+{
+private:
+    std::shared_ptr<const void> _owner;       // Memory mapping or buffer holding the input
+    const char *_base = nullptr;              // Start of the whole input
+    const SnapshotHeader *_snapshot = nullptr; // Snapshot header, if the input is a snapshot
+    const char *_data = nullptr;              // Start of the text read by the cursor
+    size_t _size = 0;                         // Size of the text in bytes
+    size_t _position = 0;                     // Position of the sequential cursor
+    bool _isOpen = false;                     // Whether the input could be opened
+    bool _failed = false;                     // Whether a sequential read ran past the end
+    int _stream = -1;                         // Descriptor of a streamed pipe, -1 for mapped inputs
+    bool _streamEnded = false;                // Whether the stream has been read to its end
+    std::vector<char> _window;                // Window over the streamed input
+
+    static constexpr size_t _windowSize = 1 << 24; // Initial window size for streamed input, 16 MiB
+
+    /**
+     * @brief Reads more of a streamed input into the window.
+     *
+     * The text before the cursor is dropped except for the last byte, which tells _skipToLineStart()
+     * whether the cursor is at a line start. The window only grows if a single line fills it.
+     *
+     * @return False for mapped inputs and once the stream has ended.
+     */
+    bool _refill()
+    {
+        if (_stream < 0 || _streamEnded)
+            return false;
+
+        size_t consumed = _position > 0 ? _position - 1 : 0;
+        memmove(_window.data(), _window.data() + consumed, _size - consumed);
+        _size -= consumed;
+        _position -= consumed;
+        if (_size == _window.size())
+            _window.resize(2 * _window.size());
+
+        while (_size < _window.size())
+        {
+            ssize_t bytesRead = read(_stream, _window.data() + _size, _window.size() - _size);
+            if (bytesRead <= 0)
+            {
+                _streamEnded = true;
+                break;
+            }
+            _size += bytesRead;
+        }
+
+        _base = _window.data();
+        _data = _window.data();
+        return true;
+    }
+
+    /**
+     * @brief Makes sure that the line at the cursor is completely in the window.
+     */
+    void _fillLine()
+    {
+        if (_stream < 0)
+            return;
+
+        while (!memchr(_data + _position, '\n', _size - _position) && _refill())
+            ;
+    }
+
+    /**
+     * @brief Maps a regular file or copies a stream into memory.
+     * @param descriptor The file descriptor to read from.
+     * @return True on success.
+     */
+    bool _load(int descriptor)
+    {
+        struct stat status;
+        if (fstat(descriptor, &status) == 0 && S_ISREG(status.st_mode))
+        {
+            size_t size = static_cast<size_t>(status.st_size);
+            if (size == 0)
+                return true;
+
+            void *mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+            if (mapping == MAP_FAILED)
+                return false;
+
+            madvise(mapping, size, MADV_SEQUENTIAL);
+            _owner = std::shared_ptr<const void>(mapping, [size](const void *address)
+                                                 { munmap(const_cast<void *>(address), size); });
+            return _open(static_cast<const char *>(mapping), size);
+        }
+
+        // Pipes and terminals cannot be mapped, stream them through the window instead
+        _stream = descriptor;
+        _window.resize(_windowSize);
+        _refill();
+        if (!::isSnapshot(_data, _size))
+            return true;
+
+        // Snapshots are accessed randomly and need to be read completely
+        while (_refill())
+            ;
+
+        std::shared_ptr<std::vector<char> > buffer = std::make_shared<std::vector<char> >(std::move(_window));
+        size_t size = _size;
+        _stream = -1;
+        _owner = buffer;
+        return _open(buffer->data(), size);
+    }
+
+    /**
+     * @brief Points the cursor at the loaded input, or at the text section of a snapshot.
+     * @param base The start of the input.
+     * @param size The size of the input in bytes.
+     * @return False if the input is a damaged snapshot.
+     */
+    bool _open(const char *base, size_t size)
+    {
+        _base = base;
+        _data = base;
+        _size = size;
+        if (!::isSnapshot(base, size))
+            return true;
+
+        // Only the header is checked by default, the full checksum would read the whole file
+        const char *verify = std::getenv("AE_VERIFY_SNAPSHOT");
+        if (!validSnapshotHeader(base, size) || (verify && *verify && *verify != '0' && !verifySnapshotChecksum(base, size)))
+            return false;
+
+        _snapshot = reinterpret_cast<const SnapshotHeader *>(base);
+        _data = base + _snapshot->textPosition;
+        _size = _snapshot->textSize;
+        return true;
+    }
+
+    /**
+     * @brief Moves the cursor to the start of the next line unless it already is at a line start.
+     */
+    void _skipToLineStart()
+    {
+        if (_position == 0 || _data[_position - 1] == '\n')
+            return;
+
+        do
+        {
+            const void *newline = memchr(_data + _position, '\n', _size - _position);
+            if (newline)
+            {
+                _position = static_cast<const char *>(newline) - _data + 1;
+                return;
+            }
+            _position = _size;
+        } while (_refill());
+    }
+
+    /**
+     * @brief Returns the position after the next newline, or the end of the input.
+     */
+    size_t _nextLine(size_t position) const
+    {
+        if (position >= _size)
+            return _size;
+
+        const void *newline = memchr(_data + position, '\n', _size - position);
+        return newline ? static_cast<const char *>(newline) - _data + 1 : _size;
+    }
+
+    /**
+     * @brief Returns whether a line holds nothing but blanks.
+     */
+    static bool _isBlank(const char *current, const char *end)
+    {
+        while (current < end && (*current == ' ' || *current == '\t' || *current == '\r'))
+            ++current;
+        return current == end;
+    }
+
+    /**
+     * @brief Passes the arcs of a snapshot to an edge callback, in CSR order.
+     * @return The number of arcs read, arcs with a vertex outside the graph are skipped and fail the reader.
+     */
+    template <typename Callback>
+    int64_t _forEachSnapshotArc(int vertices, int64_t lines, Callback &callback)
+    {
+        const int64_t *offsets = reinterpret_cast<const int64_t *>(_base + _snapshot->offsetsPosition);
+        const int *targets = reinterpret_cast<const int *>(_base + _snapshot->targetsPosition);
+        const int *weights = reinterpret_cast<const int *>(_base + _snapshot->weightsPosition);
+        lines = std::max<int64_t>(0, std::min(lines, _snapshot->numberOfArcs));
+
+        std::atomic<bool> invalid(false);
+        parallelFor(0, _snapshot->numberOfVertices, [&](int threadID, int64_t first, int64_t last)
+                    {
+                        for (int64_t vertex = first; vertex < last; ++vertex)
+                            for (int64_t arc = offsets[vertex]; arc < std::min(offsets[vertex + 1], lines); ++arc)
+                            {
+                                if (vertex >= vertices || targets[arc] < 0 || targets[arc] >= vertices)
+                                {
+                                    invalid.store(true, std::memory_order_relaxed);
+                                    continue;
+                                }
+                                callback(threadID, arc, static_cast<int>(vertex), targets[arc], weights[arc]);
+                            }
+                    });
+
+        _failed |= invalid.load();
+        return lines;
+    }
+
+    /**
+     * @brief Hands the lines between the cursor and a limit to a callback in parallel chunks.
+     * @param lines The maximum number of lines, blank lines are skipped and not counted.
+     * @param lineOffset The index of the first line passed to the callback.
+     * @param limit The end of the text to read, a line start or the end of the input.
+     * @param callback The line callback of forEachLine().
+     * @return The number of lines actually read.
+     */
+    template <typename Callback>
+    int64_t _forEachLineBefore(int64_t lines, int64_t lineOffset, size_t limit, Callback &callback)
+    {
+        size_t begin = _position;
+        size_t length = limit - begin;
+
+        // Split the section into chunks at line boundaries, at least 1 MiB each
+        int chunks = static_cast<int>(std::min<size_t>(numberOfThreads(), length / (1 << 20) + 1));
+        std::vector<size_t> bounds(chunks + 1, limit);
+        bounds[0] = begin;
+        for (int chunk = 1; chunk < chunks; ++chunk)
+            bounds[chunk] = std::max(bounds[chunk - 1], _nextLine(begin + length * chunk / chunks - 1));
+
+        // Count the non-blank lines of every chunk, a last line without newline counts as well
+        std::vector<int64_t> lineCount(chunks, 0);
+        parallelRun(chunks, [&](int chunk)
+                    {
+                        const char *current = _data + bounds[chunk];
+                        const char *end = _data + bounds[chunk + 1];
+                        int64_t count = 0;
+                        while (current < end)
+                        {
+                            const char *newline = static_cast<const char *>(memchr(current, '\n', end - current));
+                            const char *lineEnd = newline ? newline : end;
+                            count += !_isBlank(current, lineEnd);
+                            current = newline ? newline + 1 : end;
+                        }
+                        lineCount[chunk] = count;
+                    });
+
+        // Locate the end of the section and cut the chunks there
+        std::vector<int64_t> firstLine(chunks + 1, 0);
+        for (int chunk = 0; chunk < chunks; ++chunk)
+            firstLine[chunk + 1] = firstLine[chunk] + lineCount[chunk];
+
+        lines = std::max<int64_t>(0, std::min(lines, firstLine[chunks]));
+        for (int chunk = 0; chunk < chunks; ++chunk)
+        {
+            if (firstLine[chunk + 1] < lines)
+                continue;
+
+            size_t end = bounds[chunk + 1];
+            if (firstLine[chunk + 1] > lines)
+            {
+                end = bounds[chunk];
+                for (int64_t line = firstLine[chunk]; line < lines;)
+                {
+                    size_t next = _nextLine(end);
+                    line += !_isBlank(_data + end, _data + next - (_data[next - 1] == '\n'));
+                    end = next;
+                }
+            }
+
+            for (int later = chunk + 1; later <= chunks; ++later)
+                bounds[later] = end;
+            break;
+        }
+
+        // Hand out the lines of every chunk
+        parallelRun(chunks, [&](int chunk)
+                    {
+                        const char *current = _data + bounds[chunk];
+                        const char *end = _data + bounds[chunk + 1];
+                        int64_t line = firstLine[chunk];
+                        while (current < end)
+                        {
+                            const char *newline = static_cast<const char *>(memchr(current, '\n', end - current));
+                            const char *lineEnd = newline ? newline : end;
+                            if (!_isBlank(current, lineEnd))
+                                callback(chunk, lineOffset + line++, current, lineEnd);
+                            current = newline ? newline + 1 : end;
+                        }
+                    });
+
+        _position = bounds[chunks];
+        return lines;
+    }
+
+public:
+    /**
+     * @brief Opens the input.
+     * @param path The file to read, or nullptr / "-" for standard input.
+     */
+    explicit GraphReader(const char *path)
+    {
+        if (path == nullptr || strcmp(path, "-") == 0)
+        {
+            _isOpen = _load(STDIN_FILENO);
+            return;
+        }
+
+        int descriptor = open(path, O_RDONLY);
+        if (descriptor < 0)
+            return;
+
+        _isOpen = _load(descriptor);
+        if (_stream != descriptor)
+            close(descriptor);
+    }
+
+    ~GraphReader()
+    {
+        if (_stream > STDIN_FILENO)
+            close(_stream);
+    }
+
+    GraphReader(const GraphReader &) = delete;
+    GraphReader &operator=(const GraphReader &) = delete;
+
+    /**
+     * @brief Returns whether the input could be opened
+     * @return True if the input is open
+     */
+    bool isOpen() const { return _isOpen; }
+
+    /**
+     * @brief Returns whether the input is a binary snapshot
+     * @return True for snapshots
+     */
+    bool isSnapshot() const { return _snapshot != nullptr; }
+
+    /**
+     * @brief Returns false once a sequential read ran past the end of the input, like an ifstream
+     */
+    explicit operator bool() const { return !_failed; }
+
+    /**
+     * @brief Reads the next integer with the sequential cursor.
+     * @param value The integer read, unchanged at the end of the input.
+     * @return The reader itself.
+     */
+    GraphReader &operator>>(long long &value)
+    {
+        do
+        {
+            while (_position < _size && (_data[_position] == ' ' || _data[_position] == '\n' || _data[_position] == '\t' || _data[_position] == '\r'))
+                ++_position;
+        } while (_position >= _size && _refill());
+
+        if (_position >= _size)
+        {
+            _failed = true;
+            return *this;
+        }
+
+        // A number never spans lines, so it is complete once its line is
+        _fillLine();
+        long long result;
+        _position = parseInteger(_data + _position, _data + _size, result) - _data;
+        value = result;
+        return *this;
+    }
+
+    GraphReader &operator>>(int &value)
+    {
+        long long result;
+        if (*this >> result)
+            value = static_cast<int>(result);
+        return *this;
+    }
+
+    /**
+     * @brief Hands the next lines of text to a callback in parallel chunks.
+     *
+     * The section starts at the line after the sequential cursor and ends after the given number
+     * of lines or at the end of the input, whichever comes first. The cursor is moved behind it.
+     * Blank lines are skipped without counting them, like operator>> skips them. Streamed input is
+     * handed out one window at a time.
+     *
+     * @param lines The number of lines.
+     * @param callback Called as callback(threadID, lineIndex, lineBegin, lineEnd) for every line.
+     *                 Different threads run concurrently, threadID is below numberOfThreads().
+     * @return The number of lines actually read.
+     */
+    template <typename Callback>
+    int64_t forEachLine(int64_t lines, Callback callback)
+    {
+        _skipToLineStart();
+        if (_stream < 0)
+            return _forEachLineBefore(lines, 0, _size, callback);
+
+        int64_t linesRead = 0;
+        while (linesRead < lines)
+        {
+            // Only complete lines are handed out, the rest of the window waits for the next refill
+            _refill();
+            size_t limit = _size;
+            if (!_streamEnded)
+            {
+                const void *newline = memrchr(_data + _position, '\n', _size - _position);
+                limit = newline ? static_cast<const char *>(newline) - _data + 1 : _position;
+            }
+
+            if (limit == _position)
+            {
+                if (_streamEnded)
+                    break;
+                continue;
+            }
+
+            linesRead += _forEachLineBefore(lines - linesRead, linesRead, limit, callback);
+        }
+
+        return linesRead;
+    }
+
+    /**
+     * @brief Parses the next edge lines in parallel without storing them.
+     *
+     * Every line must hold one "source destination weight" triple; source and destination are 1-indexed
+     * in the input and passed on 0-indexed. The section is delimited like in forEachLine(). A line with
+     * a vertex outside 1..vertices is not passed on and fails the reader, check it with operator bool.
+     *
+     * @param vertices The number of vertices of the graph.
+     * @param lines The number of edge lines.
+     * @param callback Called as callback(threadID, lineIndex, source, destination, weight).
+     *                 Different threads run concurrently, threadID is below numberOfThreads().
+     * @return The number of edge lines actually read.
+     */
+    template <typename Callback>
+    int64_t forEachEdge(int vertices, int64_t lines, Callback callback)
+    {
+        AE_PHASE("parse");
+        _skipToLineStart();
+        if (_snapshot)
+            return _forEachSnapshotArc(vertices, lines, callback);
+
+        std::atomic<bool> invalid(false);
+        int64_t linesRead = forEachLine(lines, [&](int threadID, int64_t line, const char *current, const char *end)
+                                        {
+                                            long long source, destination, weight;
+                                            current = parseInteger(current, end, source);
+                                            current = parseInteger(current, end, destination);
+                                            parseInteger(current, end, weight);
+                                            if (source < 1 || source > vertices || destination < 1 || destination > vertices)
+                                            {
+                                                invalid.store(true, std::memory_order_relaxed);
+                                                return;
+                                            }
+                                            callback(threadID, line, static_cast<int>(source - 1), static_cast<int>(destination - 1), static_cast<int>(weight));
+                                        });
+
+        _failed |= invalid.load();
+        return linesRead;
+    }
+
+    /**
+     * @brief Reads the next lines holding one integer each, e.g. a partition or vertex weights.
+     * @param lines The number of lines.
+     * @return The values, fewer than requested if the input ends early.
+     */
+    std::vector<int> readValues(int64_t lines)
+    {
+        AE_PHASE("parse");
+        std::vector<int> values(std::max<int64_t>(0, lines));
+        int *output = values.data();
+        int64_t linesRead = forEachLine(lines, [output](int, int64_t line, const char *current, const char *end)
+                                        {
+                                            long long value;
+                                            parseInteger(current, end, value);
+                                            output[line] = static_cast<int>(value);
+                                        });
+        values.resize(linesRead);
+        return values;
+    }
+
+    /**
+     * @brief Reads the next edge lines into an edge array.
+     *
+     * For snapshots the edges come grouped by source vertex instead of in the original input order.
+     * An edge with a vertex outside the graph fails the reader like in forEachEdge().
+     *
+     * @param vertices The number of vertices of the graph.
+     * @param lines The number of edge lines.
+     * @return The edges, 0-indexed, in input order, or none once the reader failed.
+     */
+    std::vector<InputEdge> readEdges(int vertices, int64_t lines)
+    {
+        std::vector<InputEdge> edges(std::max<int64_t>(0, lines));
+        InputEdge *output = edges.data();
+        int64_t linesRead = forEachEdge(vertices, lines, [output](int, int64_t line, int source, int destination, int weight)
+                                        { output[line] = InputEdge{source, destination, weight}; });
+        edges.resize(_failed ? 0 : linesRead);
+        return edges;
+    }
+
+    /**
+     * @brief Reads the next edge lines into a CSR graph.
+     *
+     * An edge with a vertex outside the graph fails the reader and leaves the graph without edges.
+     *
+     * @param vertices The number of vertices of the graph.
+     * @param lines The number of edge lines.
+     * @return The graph.
+     */
+    CSRGraph readGraph(int vertices, int64_t lines)
+    {
+        // Snapshots already hold the graph, hand out the mapped arrays without parsing or copying
+        if (_snapshot && _snapshot->numberOfVertices == vertices && lines >= _snapshot->numberOfArcs)
+        {
+            _skipToLineStart();
+            return snapshotGraph(_base, _owner);
+        }
+
+        std::vector<InputEdge> edges = readEdges(vertices, lines);
+        AE_PHASE("build");
+        return CSRGraph(vertices, edges);
+    }
+
+    /**
+     * @brief Reads the rest of the current line with the sequential cursor, including the newline.
+     * @return The text of the line.
+     */
+    std::string readLine()
+    {
+        _fillLine();
+        size_t end = _nextLine(_position);
+        std::string line(_data + _position, end - _position);
+        _position = end;
+        return line;
+    }
+
+    /**
+     * @brief Reads everything from the sequential cursor to the end of the input.
+     * @return The remaining text.
+     */
+    std::string remainingText()
+    {
+        std::string text;
+        do
+        {
+            text.append(_data + _position, _size - _position);
+            _position = _size;
+        } while (_refill());
+        return text;
+    }
+};
+
+#endif
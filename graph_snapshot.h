@@ -0,0 +1,216 @@
+#ifndef GRAPH_SNAPSHOT_H
+#define GRAPH_SNAPSHOT_H
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <sys/mman.h>
+
+#include "csr_graph.h"
+#include "parallel.h"
+
+/**
+ * @struct SnapshotHeader
+ * @brief Fixed-size header at the start of a binary graph snapshot.
+ *
+ * A snapshot is the header followed by four sections, each starting at a multiple of 64 bytes:
+ * the CSR offsets (int64), targets (int32), weights (int32) and the text that surrounded the edge
+ * lines in the original input (header line and trailing data such as partitions or source and target).
+ * All numbers are stored in the byte order of the machine that wrote the file.
+ */
+struct SnapshotHeader
+{
+    char magic[8];             // "AEGRAPH" followed by a zero byte
+    uint32_t version;          // Format version
+    uint32_t byteOrder;        // 0x01020304 as written by the producing machine
+    int64_t numberOfVertices;  // Number of vertices
+    int64_t numberOfArcs;      // Number of arcs
+    uint64_t offsetsPosition;  // Byte position of the offset section
+    uint64_t targetsPosition;  // Byte position of the target section
+    uint64_t weightsPosition;  // Byte position of the weight section
+    uint64_t textPosition;     // Byte position of the text section
+    uint64_t textSize;         // Size of the text section in bytes
+    uint64_t fileSize;         // Size of the whole file in bytes
+    uint64_t checksum;         // Checksum of everything after the header
+};
+
+const char snapshotMagic[8] = {'A', 'E', 'G', 'R', 'A', 'P', 'H', '\0'};
+const uint32_t snapshotVersion = 1;
+const uint32_t snapshotByteOrder = 0x01020304;
+
+/**
+ * @brief Returns whether a buffer starts with the snapshot magic
+ * @param data The buffer
+ * @param size The size of the buffer
+ * @return True if the buffer looks like a snapshot
+ */
+inline bool isSnapshot(const char *data, size_t size)
+{
+    return size >= sizeof(SnapshotHeader) && memcmp(data, snapshotMagic, sizeof(snapshotMagic)) == 0;
+}
+
+/**
+ * @brief Computes the snapshot checksum of a buffer.
+ *
+ * The buffer is hashed in 1 MiB blocks on all threads with a multiply-xorshift over 64-bit words,
+ * then the block hashes are combined in order.
+ *
+ * @param data The buffer
+ * @param size The size of the buffer
+ * @return The checksum
+ */
+inline uint64_t snapshotChecksum(const char *data, size_t size)
+{
+    const size_t blockSize = 1 << 20;
+    int64_t blocks = static_cast<int64_t>((size + blockSize - 1) / blockSize);
+    std::vector<uint64_t> blockHashes(blocks);
+
+    parallelFor(0, blocks, [&](int, int64_t first, int64_t last)
+                {
+                    for (int64_t block = first; block < last; ++block)
+                    {
+                        size_t begin = block * blockSize;
+                        size_t end = std::min(size, begin + blockSize);
+                        uint64_t hash = 0x9E3779B97F4A7C15ULL ^ (end - begin);
+                        size_t position = begin;
+                        for (; position + 8 <= end; position += 8)
+                        {
+                            uint64_t word;
+                            memcpy(&word, data + position, 8);
+                            hash = (hash ^ word) * 0xFF51AFD7ED558CCDULL;
+                            hash ^= hash >> 32;
+                        }
+                        for (; position < end; ++position)
+                            hash = (hash ^ static_cast<unsigned char>(data[position])) * 0x100000001B3ULL;
+                        blockHashes[block] = hash;
+                    }
+                }, 4);
+
+    uint64_t checksum = 0xCBF29CE484222325ULL;
+    for (uint64_t hash : blockHashes)
+        checksum = (checksum ^ hash) * 0x100000001B3ULL;
+    return checksum;
+}
+
+/**
+ * @brief Returns the next multiple of 64 bytes
+ */
+inline uint64_t snapshotAlign(uint64_t position)
+{
+    return (position + 63) & ~static_cast<uint64_t>(63);
+}
+
+/**
+ * @brief Writes a graph and the text around its edge lines to a binary snapshot.
+ * @param path The file to write.
+ * @param graph The graph.
+ * @param text The header line and trailing data of the original input.
+ * @return True on success.
+ */
+inline bool writeSnapshot(const char *path, const CSRGraph &graph, const std::string &text)
+{
+    SnapshotHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, snapshotMagic, sizeof(snapshotMagic));
+    header.version = snapshotVersion;
+    header.byteOrder = snapshotByteOrder;
+    header.numberOfVertices = graph.numberOfVertices();
+    header.numberOfArcs = graph.numberOfArcs();
+    header.offsetsPosition = snapshotAlign(sizeof(SnapshotHeader));
+    header.targetsPosition = snapshotAlign(header.offsetsPosition + (header.numberOfVertices + 1) * sizeof(int64_t));
+    header.weightsPosition = snapshotAlign(header.targetsPosition + header.numberOfArcs * sizeof(int));
+    header.textPosition = snapshotAlign(header.weightsPosition + header.numberOfArcs * sizeof(int));
+    header.textSize = text.size();
+    header.fileSize = header.textPosition + header.textSize;
+
+    FILE *file = fopen(path, "w+b");
+    if (!file)
+        return false;
+
+    // Write the sections with zero padding up to their aligned positions
+    uint64_t position = 0;
+    bool written = true;
+    auto writeSection = [&](uint64_t sectionPosition, const void *data, size_t bytes)
+    {
+        static const char padding[64] = {};
+        written = written && fwrite(padding, 1, sectionPosition - position, file) == sectionPosition - position;
+        written = written && (bytes == 0 || fwrite(data, 1, bytes, file) == bytes);
+        position = sectionPosition + bytes;
+    };
+    writeSection(0, &header, sizeof(header));
+    writeSection(header.offsetsPosition, graph.offsets(), (header.numberOfVertices + 1) * sizeof(int64_t));
+    writeSection(header.targetsPosition, graph.targets(), header.numberOfArcs * sizeof(int));
+    writeSection(header.weightsPosition, graph.weights(), header.numberOfArcs * sizeof(int));
+    writeSection(header.textPosition, text.data(), text.size());
+    written = written && fflush(file) == 0;
+
+    // Checksum the payload from the written file instead of assembling a second copy in memory
+    if (written)
+    {
+        void *mapping = mmap(nullptr, header.fileSize, PROT_READ, MAP_SHARED, fileno(file), 0);
+        written = mapping != MAP_FAILED;
+        if (written)
+        {
+            header.checksum = snapshotChecksum(static_cast<const char *>(mapping) + sizeof(SnapshotHeader), header.fileSize - sizeof(SnapshotHeader));
+            munmap(mapping, header.fileSize);
+            written = fseek(file, 0, SEEK_SET) == 0 && fwrite(&header, sizeof(header), 1, file) == 1;
+        }
+    }
+
+    return fclose(file) == 0 && written;
+}
+
+/**
+ * @brief Checks the structure of a mapped snapshot without reading its payload.
+ * @param data The start of the snapshot.
+ * @param size The size of the snapshot in bytes.
+ * @return True if the header is consistent with the file.
+ */
+inline bool validSnapshotHeader(const char *data, size_t size)
+{
+    if (!isSnapshot(data, size))
+        return false;
+
+    const SnapshotHeader &header = *reinterpret_cast<const SnapshotHeader *>(data);
+    return header.version == snapshotVersion && header.byteOrder == snapshotByteOrder &&
+           header.fileSize == size && header.numberOfVertices >= 0 && header.numberOfArcs >= 0 &&
+           header.offsetsPosition % 64 == 0 && header.targetsPosition % 64 == 0 && header.weightsPosition % 64 == 0 &&
+           header.offsetsPosition + (header.numberOfVertices + 1) * sizeof(int64_t) <= header.targetsPosition &&
+           header.targetsPosition + header.numberOfArcs * sizeof(int) <= header.weightsPosition &&
+           header.weightsPosition + header.numberOfArcs * sizeof(int) <= header.textPosition &&
+           header.textPosition + header.textSize == size &&
+           reinterpret_cast<const int64_t *>(data + header.offsetsPosition)[header.numberOfVertices] == header.numberOfArcs;
+}
+
+/**
+ * @brief Verifies the checksum of a mapped snapshot, this reads the whole file.
+ * @param data The start of the snapshot.
+ * @param size The size of the snapshot in bytes.
+ * @return True if the checksum matches.
+ */
+inline bool verifySnapshotChecksum(const char *data, size_t size)
+{
+    const SnapshotHeader &header = *reinterpret_cast<const SnapshotHeader *>(data);
+    return snapshotChecksum(data + sizeof(SnapshotHeader), size - sizeof(SnapshotHeader)) == header.checksum;
+}
+
+/**
+ * @brief Wraps the CSR sections of a mapped snapshot without copying them.
+ * @param data The start of the snapshot, must be 8-byte aligned.
+ * @param owner Keeps the mapping alive as long as the graph exists.
+ * @return The graph.
+ */
+inline CSRGraph snapshotGraph(const char *data, std::shared_ptr<const void> owner)
+{
+    const SnapshotHeader &header = *reinterpret_cast<const SnapshotHeader *>(data);
+    return CSRGraph(static_cast<int>(header.numberOfVertices),
+                    reinterpret_cast<const int64_t *>(data + header.offsetsPosition),
+                    reinterpret_cast<const int *>(data + header.targetsPosition),
+                    reinterpret_cast<const int *>(data + header.weightsPosition),
+                    std::move(owner));
+}
+
+#endif
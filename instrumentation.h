@@ -0,0 +1,187 @@
+#ifndef INSTRUMENTATION_H
+#define INSTRUMENTATION_H
+
+/**
+ * Per-phase wall times and algorithm counters, compiled in only with -DAE_INSTRUMENT.
+ *
+ *     AE_PHASE("algorithm");        // times the rest of the enclosing scope
+ *     AE_COUNT("augmentations", 1); // adds to a named counter
+ *
+ * Phases opened inside other phases are reported under their full path such as "algorithm/output".
+ * At program exit the report is written as JSON to the file named by AE_REPORT, or to stderr.
+ * Phases are meant for the main thread, parallel kernels are timed as a whole. Counters are atomic
+ * and may be incremented from any thread.
+ * Without AE_INSTRUMENT both macros expand to nothing.
+ */
+
+#ifdef AE_INSTRUMENT
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * @class Instrumentation
+ * @brief Process-wide registry of phase times and counters, reports itself when destroyed.
+ */
+class Instrumentation
+{
+private:
+    struct Phase
+    {
+        std::string path;   // Names of the enclosing phases and this one, separated by '/'
+        double seconds = 0; // Accumulated wall time
+        long long calls = 0; // Number of times the phase was entered
+    };
+
+    std::deque<Phase> _phases;                       // Phases in order of first entry
+    std::map<std::string, size_t> _phaseIndex;       // Position of every phase path in _phases
+    std::vector<size_t> _openPhases;                 // Stack of currently open phases
+    std::map<std::string, std::atomic<long long> > _counters; // Counters by name
+    std::mutex _counterMutex;                        // Guards registration of new counters
+
+    Instrumentation() = default;
+
+    static void _writeString(FILE *file, const std::string &text)
+    {
+        fputc('"', file);
+        for (char character : text)
+        {
+            if (character == '"' || character == '\\')
+                fputc('\\', file);
+            fputc(character, file);
+        }
+        fputc('"', file);
+    }
+
+public:
+    ~Instrumentation()
+    {
+        const char *path = getenv("AE_REPORT");
+        FILE *file = path && *path ? fopen(path, "w") : stderr;
+        if (!file)
+            return;
+
+        fprintf(file, "{\"phases\": [");
+        for (size_t i = 0; i < _phases.size(); ++i)
+        {
+            fprintf(file, "%s{\"name\": ", i ? ", " : "");
+            _writeString(file, _phases[i].path);
+            fprintf(file, ", \"seconds\": %.9f, \"calls\": %lld}", _phases[i].seconds, _phases[i].calls);
+        }
+        fprintf(file, "], \"counters\": {");
+        bool first = true;
+        for (const auto &counter : _counters)
+        {
+            fprintf(file, "%s", first ? "" : ", ");
+            _writeString(file, counter.first);
+            fprintf(file, ": %lld", counter.second.load());
+            first = false;
+        }
+        fprintf(file, "}}\n");
+
+        if (file != stderr)
+            fclose(file);
+    }
+
+    static Instrumentation &instance()
+    {
+        static Instrumentation instrumentation;
+        return instrumentation;
+    }
+
+    /**
+     * @brief Opens a phase below the currently open one
+     * @param name The name of the phase
+     * @return The index of the phase, to be passed to closePhase
+     */
+    size_t openPhase(const char *name)
+    {
+        std::string path = _openPhases.empty() ? name : _phases[_openPhases.back()].path + "/" + name;
+        auto found = _phaseIndex.find(path);
+        size_t index;
+        if (found == _phaseIndex.end())
+        {
+            index = _phases.size();
+            _phases.push_back(Phase{path, 0, 0});
+            _phaseIndex.emplace(path, index);
+        }
+        else
+            index = found->second;
+
+        _openPhases.push_back(index);
+        return index;
+    }
+
+    /**
+     * @brief Closes the innermost phase and adds its time
+     * @param index The index returned by openPhase
+     * @param seconds The time spent in the phase
+     */
+    void closePhase(size_t index, double seconds)
+    {
+        _phases[index].seconds += seconds;
+        _phases[index].calls += 1;
+        _openPhases.pop_back();
+    }
+
+    /**
+     * @brief Returns a reference to a counter, stable for the lifetime of the program
+     * @param name The name of the counter
+     */
+    std::atomic<long long> &counter(const char *name)
+    {
+        std::lock_guard<std::mutex> lock(_counterMutex);
+        return _counters[name];
+    }
+};
+
+/**
+ * @class PhaseTimer
+ * @brief Times a phase from construction to the end of the enclosing scope.
+ */
+class PhaseTimer
+{
+private:
+    size_t _index;                                     // Index of the phase in the registry
+    std::chrono::steady_clock::time_point _start;      // Start of the phase
+
+public:
+    explicit PhaseTimer(const char *name)
+        : _index(Instrumentation::instance().openPhase(name)), _start(std::chrono::steady_clock::now())
+    {
+    }
+
+    ~PhaseTimer()
+    {
+        Instrumentation::instance().closePhase(_index, std::chrono::duration<double>(std::chrono::steady_clock::now() - _start).count());
+    }
+
+    PhaseTimer(const PhaseTimer &) = delete;
+    PhaseTimer &operator=(const PhaseTimer &) = delete;
+};
+
+#define AE_CONCATENATE_(a, b) a##b
+#define AE_CONCATENATE(a, b) AE_CONCATENATE_(a, b)
+#define AE_PHASE(name) PhaseTimer AE_CONCATENATE(aePhase, __LINE__)(name)
+#define AE_COUNT(name, amount)                                                     \
+    do                                                                             \
+    {                                                                              \
+        static std::atomic<long long> &aeCounter = Instrumentation::instance().counter(name); \
+        aeCounter.fetch_add((amount), std::memory_order_relaxed);                  \
+    } while (0)
+
+#else
+
+#define AE_PHASE(name) ((void)0)
+#define AE_COUNT(name, amount) ((void)0)
+
+#endif
+
+#endif
@@ -0,0 +1,121 @@
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+// Storage for the thread count, initialized from AE_THREADS or the hardware thread count
+inline int &numberOfThreadsSetting()
+{
+    static int threads = []
+    {
+        const char *environment = std::getenv("AE_THREADS");
+        int requested = environment ? std::atoi(environment) : 0;
+        if (requested > 0)
+            return requested;
+        return std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    }();
+    return threads;
+}
+
+/**
+ * @brief Returns the number of worker threads used by the parallel loops.
+ *
+ * Defaults to the number of hardware threads and can be overridden with the AE_THREADS
+ * environment variable or setNumberOfThreads().
+ *
+ * @return The number of worker threads
+ */
+inline int numberOfThreads() { return numberOfThreadsSetting(); }
+
+/**
+ * @brief Sets the number of worker threads used by the parallel loops.
+ * @param threads The number of threads, at least 1.
+ */
+inline void setNumberOfThreads(int threads) { numberOfThreadsSetting() = std::max(1, threads); }
+
+/**
+ * @brief Runs a function on several threads and waits for all of them.
+ * @param threads The number of threads to start, the calling thread runs thread 0.
+ * @param function Called as function(threadID).
+ */
+template <typename Function>
+void parallelRun(int threads, Function function)
+{
+    std::vector<std::thread> workers;
+    workers.reserve(threads - 1);
+    for (int threadID = 1; threadID < threads; ++threadID)
+        workers.emplace_back(function, threadID);
+
+    function(0);
+
+    for (std::thread &worker : workers)
+        worker.join();
+}
+
+/**
+ * @brief Splits the index range [begin, end) into one contiguous block per thread.
+ *
+ * Small ranges run on the calling thread only, starting threads costs more than it saves there.
+ *
+ * @param begin The first index.
+ * @param end One past the last index.
+ * @param function Called as function(threadID, blockBegin, blockEnd).
+ * @param grainSize The minimum number of indices per thread.
+ * @return The number of blocks the range was split into.
+ */
+template <typename Function>
+int parallelFor(int64_t begin, int64_t end, Function function, int64_t grainSize = 1 << 14)
+{
+    int64_t length = std::max<int64_t>(0, end - begin);
+    int threads = static_cast<int>(std::min<int64_t>(numberOfThreads(), std::max<int64_t>(1, length / grainSize)));
+
+    parallelRun(threads, [&](int threadID)
+                {
+                    int64_t blockBegin = begin + length * threadID / threads;
+                    int64_t blockEnd = begin + length * (threadID + 1) / threads;
+                    function(threadID, blockBegin, blockEnd);
+                });
+
+    return threads;
+}
+
+
+/**
+ * @brief Hands out the index range [begin, end) in chunks to whichever thread is free.
+ *
+ * Use this instead of parallelFor when the cost per index varies a lot, e.g. per vertex on
+ * graphs with skewed degrees, so one thread does not end up with all expensive indices.
+ *
+ * @param begin The first index.
+ * @param end One past the last index.
+ * @param function Called as function(threadID, chunkBegin, chunkEnd), several times per thread.
+ * @param chunkSize The number of indices per chunk.
+ * @return The number of threads used.
+ */
+template <typename Function>
+int parallelForDynamic(int64_t begin, int64_t end, Function function, int64_t chunkSize = 256)
+{
+    int64_t length = std::max<int64_t>(0, end - begin);
+    int threads = static_cast<int>(std::min<int64_t>(numberOfThreads(), std::max<int64_t>(1, length / chunkSize)));
+    std::atomic<int64_t> nextChunk(begin);
+
+    parallelRun(threads, [&](int threadID)
+                {
+                    while (true)
+                    {
+                        int64_t chunkBegin = nextChunk.fetch_add(chunkSize, std::memory_order_relaxed);
+                        if (chunkBegin >= end)
+                            break;
+                        function(threadID, chunkBegin, std::min(end, chunkBegin + chunkSize));
+                    }
+                });
+
+    return threads;
+}
+
+#endif
@@ -0,0 +1,174 @@
+#ifndef RESULT_WRITER_H
+#define RESULT_WRITER_H
+
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include <unistd.h>
+
+/**
+ * @brief Returns whether results should be written in binary, read once from AE_BINARY_OUTPUT
+ * @return True if AE_BINARY_OUTPUT is set to a non-zero value
+ */
+inline bool binaryOutputSetting()
+{
+    const char *setting = std::getenv("AE_BINARY_OUTPUT");
+    return setting && std::atoi(setting) != 0;
+}
+
+/**
+ * @class ResultWriter
+ * @brief Buffered output for large results such as edge lists and vertex sets.
+ *
+ * Integers are formatted with std::to_chars into a large block that is handed to the operating
+ * system with a single write() once it is full, instead of going through the locale and stream
+ * state of cout for every value.
+ *
+ * In binary mode every integer is stored as a native-endian int64, every double as its 8 bytes, and
+ * characters and strings are dropped, so a result of k numbers is exactly 8k bytes. The writer
+ * bypasses cout, so both must not be mixed on the same descriptor without flushing cout first.
+ */
+class ResultWriter
+{
+private:
+    int _descriptor;     // File descriptor to write to
+    bool _binary;        // Store integers as int64 instead of text
+    bool _failed = false; // Whether a write failed
+    std::vector<char> _block; // Output block
+    size_t _used = 0;    // Bytes used in the block
+
+    void _reserve(size_t bytes)
+    {
+        if (_used + bytes > _block.size())
+            flush();
+    }
+
+public:
+    /**
+     * @brief Creates a writer
+     * @param descriptor The file descriptor to write to, standard output by default.
+     * @param binary Whether to write integers in binary.
+     * @param blockSize The size of the output block in bytes.
+     */
+    explicit ResultWriter(int descriptor = STDOUT_FILENO, bool binary = binaryOutputSetting(), size_t blockSize = 1 << 20)
+        : _descriptor(descriptor), _binary(binary), _block(std::max<size_t>(blockSize, 64))
+    {
+    }
+
+    ~ResultWriter() { flush(); }
+
+    ResultWriter(const ResultWriter &) = delete;
+    ResultWriter &operator=(const ResultWriter &) = delete;
+
+    /**
+     * @brief Returns whether the writer stores integers in binary
+     */
+    bool binary() const { return _binary; }
+
+    /**
+     * @brief Returns whether every write so far succeeded
+     */
+    bool good() const { return !_failed; }
+
+    /**
+     * @brief Writes the block to the file descriptor
+     */
+    void flush()
+    {
+        size_t written = 0;
+        while (written < _used && !_failed)
+        {
+            ssize_t result = ::write(_descriptor, _block.data() + written, _used - written);
+            if (result > 0)
+                written += result;
+            else if (result < 0 && errno != EINTR)
+                _failed = true;
+        }
+        _used = 0;
+    }
+
+    template <typename Integer, typename std::enable_if<std::is_integral<Integer>::value && !std::is_same<Integer, char>::value && !std::is_same<Integer, bool>::value, int>::type = 0>
+    ResultWriter &operator<<(Integer value)
+    {
+        if (_binary)
+        {
+            _reserve(sizeof(int64_t));
+            int64_t wide = static_cast<int64_t>(value);
+            memcpy(_block.data() + _used, &wide, sizeof(wide));
+            _used += sizeof(wide);
+        }
+        else
+        {
+            _reserve(24);
+            _used = std::to_chars(_block.data() + _used, _block.data() + _block.size(), value).ptr - _block.data();
+        }
+        return *this;
+    }
+
+    /**
+     * @brief Appends a floating point number with 6 significant digits, or its 8 bytes in binary mode
+     */
+    ResultWriter &operator<<(double value)
+    {
+        if (_binary)
+            write(reinterpret_cast<const char *>(&value), sizeof(value));
+        else
+        {
+            _reserve(32);
+            _used += snprintf(_block.data() + _used, 32, "%.6g", value);
+        }
+        return *this;
+    }
+
+    ResultWriter &operator<<(char character)
+    {
+        if (!_binary)
+        {
+            _reserve(1);
+            _block[_used++] = character;
+        }
+        return *this;
+    }
+
+    ResultWriter &operator<<(const char *text)
+    {
+        if (!_binary)
+            write(text, strlen(text));
+        return *this;
+    }
+
+    ResultWriter &operator<<(const std::string &text)
+    {
+        if (!_binary)
+            write(text.data(), text.size());
+        return *this;
+    }
+
+    /**
+     * @brief Appends raw bytes, also in binary mode
+     * @param data The bytes
+     * @param size The number of bytes
+     */
+    void write(const char *data, size_t size)
+    {
+        while (size > 0)
+        {
+            _reserve(std::min(size, _block.size()));
+            size_t chunk = std::min(size, _block.size() - _used);
+            memcpy(_block.data() + _used, data, chunk);
+            _used += chunk;
+            data += chunk;
+            size -= chunk;
+        }
+    }
+};
+
+#endif
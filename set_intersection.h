@@ -0,0 +1,211 @@
+#ifndef SET_INTERSECTION_H
+#define SET_INTERSECTION_H
+
+#include <algorithm>
+#include <cstdint>
+
+#include "cpu_features.h"
+
+/**
+ * Intersection of two sorted, duplicate-free arrays of vertex IDs.
+ *
+ * Arrays of similar length are merged block-wise with SIMD all-pairs comparisons: 4x4 elements per
+ * step with SSE2, 8x8 with AVX2 if the processor supports it (checked once at run time). If one array
+ * is much longer than the other, each element of the short one is searched in the long one with
+ * galloping (exponential) search instead. Without x86 SIMD support a scalar merge is used.
+ *
+ * The kernels report matches instead of counting them, so the same code serves intersectionSize()
+ * and forEachCommonElement(). A merge kernel calls report(position, mask) where bit k of mask stands
+ * for a[position + k]; the galloping kernel calls report(i, j) for a[i] == b[j].
+ */
+
+/**
+ * @brief Scalar merge intersection, also used for the tails of the SIMD kernels
+ */
+template <typename Report>
+inline void scalarIntersection(const int *a, int64_t aSize, const int *b, int64_t bSize, Report &&report)
+{
+    int64_t i = 0, j = 0;
+    while (i < aSize && j < bSize)
+    {
+        if (a[i] < b[j])
+            ++i;
+        else if (a[i] > b[j])
+            ++j;
+        else
+        {
+            report(i, 1u);
+            ++i;
+            ++j;
+        }
+    }
+}
+
+/**
+ * @brief Galloping intersection for a short array a and a long array b
+ */
+template <typename Report>
+inline void gallopingIntersection(const int *a, int64_t aSize, const int *b, int64_t bSize, Report &&report)
+{
+    int64_t low = 0;
+    for (int64_t i = 0; i < aSize && low < bSize; ++i)
+    {
+        // Double the step until b[high] >= a[i], then binary search in the last step
+        int64_t step = 1;
+        int64_t high = low;
+        while (high < bSize && b[high] < a[i])
+        {
+            low = high + 1;
+            high += step;
+            step *= 2;
+        }
+        high = std::min(high, bSize);
+        low = std::lower_bound(b + low, b + high, a[i]) - b;
+        if (low < bSize && b[low] == a[i])
+        {
+            report(i, low);
+            ++low;
+        }
+    }
+}
+
+#ifdef AE_X86_SIMD
+
+/**
+ * @brief SSE2 kernel, compares blocks of 4 against 4 elements
+ */
+template <typename Report>
+inline void sseIntersection(const int *a, int64_t aSize, const int *b, int64_t bSize, Report &&report)
+{
+    int64_t i = 0, j = 0;
+    while (i + 4 <= aSize && j + 4 <= bSize)
+    {
+        __m128i blockA = _mm_loadu_si128(reinterpret_cast<const __m128i *>(a + i));
+        __m128i blockB = _mm_loadu_si128(reinterpret_cast<const __m128i *>(b + j));
+
+        // Compare a against all four rotations of b, every element of a matches at most once
+        __m128i matches = _mm_cmpeq_epi32(blockA, blockB);
+        matches = _mm_or_si128(matches, _mm_cmpeq_epi32(blockA, _mm_shuffle_epi32(blockB, _MM_SHUFFLE(0, 3, 2, 1))));
+        matches = _mm_or_si128(matches, _mm_cmpeq_epi32(blockA, _mm_shuffle_epi32(blockB, _MM_SHUFFLE(1, 0, 3, 2))));
+        matches = _mm_or_si128(matches, _mm_cmpeq_epi32(blockA, _mm_shuffle_epi32(blockB, _MM_SHUFFLE(2, 1, 0, 3))));
+        unsigned mask = _mm_movemask_ps(_mm_castsi128_ps(matches));
+        if (mask)
+            report(i, mask);
+
+        // Advance the block with the smaller last element, both if they are equal
+        int lastA = a[i + 3], lastB = b[j + 3];
+        i += (lastA <= lastB) ? 4 : 0;
+        j += (lastB <= lastA) ? 4 : 0;
+    }
+    scalarIntersection(a + i, aSize - i, b + j, bSize - j, [&](int64_t position, unsigned mask)
+                       { report(i + position, mask); });
+}
+
+/**
+ * @brief AVX2 kernel, compares blocks of 8 against 8 elements
+ */
+template <typename Report>
+__attribute__((target("avx2"))) inline void avx2Intersection(const int *a, int64_t aSize, const int *b, int64_t bSize, Report &&report)
+{
+    const __m256i rotate = _mm256_setr_epi32(1, 2, 3, 4, 5, 6, 7, 0);
+    int64_t i = 0, j = 0;
+    while (i + 8 <= aSize && j + 8 <= bSize)
+    {
+        __m256i blockA = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(a + i));
+        __m256i blockB = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b + j));
+
+        __m256i matches = _mm256_cmpeq_epi32(blockA, blockB);
+        for (int rotation = 1; rotation < 8; ++rotation)
+        {
+            blockB = _mm256_permutevar8x32_epi32(blockB, rotate);
+            matches = _mm256_or_si256(matches, _mm256_cmpeq_epi32(blockA, blockB));
+        }
+        unsigned mask = _mm256_movemask_ps(_mm256_castsi256_ps(matches));
+        if (mask)
+            report(i, mask);
+
+        int lastA = a[i + 7], lastB = b[j + 7];
+        i += (lastA <= lastB) ? 8 : 0;
+        j += (lastB <= lastA) ? 8 : 0;
+    }
+    sseIntersection(a + i, aSize - i, b + j, bSize - j, [&](int64_t position, unsigned mask)
+                    { report(i + position, mask); });
+}
+
+#endif
+
+/**
+ * @brief Runs the merge kernel the processor supports
+ */
+template <typename Report>
+inline void mergeIntersection(const int *a, int64_t aSize, const int *b, int64_t bSize, Report &&report)
+{
+#ifdef AE_X86_SIMD
+    if (hasAVX2())
+        avx2Intersection(a, aSize, b, bSize, report);
+    else
+        sseIntersection(a, aSize, b, bSize, report);
+#else
+    scalarIntersection(a, aSize, b, bSize, report);
+#endif
+}
+
+/**
+ * @brief Returns the size of the intersection of two sorted, duplicate-free arrays
+ * @param a The first array
+ * @param aSize The length of the first array
+ * @param b The second array
+ * @param bSize The length of the second array
+ * @return The number of elements in both arrays
+ */
+inline int64_t intersectionSize(const int *a, int64_t aSize, const int *b, int64_t bSize)
+{
+    if (aSize > bSize)
+    {
+        std::swap(a, b);
+        std::swap(aSize, bSize);
+    }
+    if (aSize == 0)
+        return 0;
+
+    int64_t count = 0;
+    // Strongly skewed sizes, searching is cheaper than touching every element of b
+    if (aSize * 32 < bSize)
+        gallopingIntersection(a, aSize, b, bSize, [&](int64_t, int64_t)
+                              { ++count; });
+    else
+        mergeIntersection(a, aSize, b, bSize, [&](int64_t, unsigned mask)
+                          { count += __builtin_popcount(mask); });
+    return count;
+}
+
+/**
+ * @brief Calls a function for every element of a sorted, duplicate-free array that is also in another one
+ * @param a The array whose positions are reported
+ * @param aSize The length of the first array
+ * @param b The second array
+ * @param bSize The length of the second array
+ * @param visit Called with the position in a of every common element, in increasing order
+ */
+template <typename Visit>
+inline void forEachCommonElement(const int *a, int64_t aSize, const int *b, int64_t bSize, Visit &&visit)
+{
+    if (aSize == 0 || bSize == 0)
+        return;
+
+    // Gallop with the short array, whichever of the two it is
+    if (aSize * 32 < bSize)
+        gallopingIntersection(a, aSize, b, bSize, [&](int64_t i, int64_t)
+                              { visit(i); });
+    else if (bSize * 32 < aSize)
+        gallopingIntersection(b, bSize, a, aSize, [&](int64_t, int64_t i)
+                              { visit(i); });
+    else
+        mergeIntersection(a, aSize, b, bSize, [&](int64_t position, unsigned mask)
+                          {
+                              for (; mask; mask &= mask - 1)
+                                  visit(position + __builtin_ctz(mask));
+                          });
+}
+
+#endif
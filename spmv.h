@@ -0,0 +1,146 @@
+#ifndef SPMV_H
+#define SPMV_H
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "cpu_features.h"
+#include "csr_graph.h"
+#include "parallel.h"
+
+/**
+ * Sparse matrix-vector products with the weighted adjacency matrix of a CSRGraph.
+ *
+ * The rows are split into one block per thread with about the same number of rows plus arcs, so a
+ * few vertices of very high degree do not leave the other threads idle. Within a row the AVX2 kernel
+ * gathers eight entries of x per step and multiplies them with the converted weights, using two
+ * accumulators to hide the latency of the additions. Without AVX2 support (checked once at run time)
+ * a scalar loop is used. The summation order differs between both, so results may differ in the
+ * last bits.
+ */
+
+/**
+ * @brief Scalar dot product of one row of the adjacency matrix with x
+ */
+inline double scalarRowProduct(const int *targets, const int *weights, int64_t first, int64_t last, const double *x)
+{
+    double sum = 0;
+    for (int64_t arc = first; arc < last; ++arc)
+        sum += weights[arc] * x[targets[arc]];
+    return sum;
+}
+
+#ifdef AE_X86_SIMD
+
+/**
+ * @brief AVX2 dot product of one row of the adjacency matrix with x, gathers 8 entries per step
+ */
+__attribute__((target("avx2"))) inline double avx2RowProduct(const int *targets, const int *weights, int64_t first, int64_t last, const double *x)
+{
+    // The masked gather with an explicit source avoids reading an undefined register
+    const __m256d zero = _mm256_setzero_pd();
+    const __m256d all = _mm256_castsi256_pd(_mm256_set1_epi64x(-1));
+    __m256d sum0 = zero;
+    __m256d sum1 = zero;
+    int64_t arc = first;
+    for (; arc + 8 <= last; arc += 8)
+    {
+        __m128i indices0 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(targets + arc));
+        __m128i indices1 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(targets + arc + 4));
+        __m256d weights0 = _mm256_cvtepi32_pd(_mm_loadu_si128(reinterpret_cast<const __m128i *>(weights + arc)));
+        __m256d weights1 = _mm256_cvtepi32_pd(_mm_loadu_si128(reinterpret_cast<const __m128i *>(weights + arc + 4)));
+        sum0 = _mm256_add_pd(sum0, _mm256_mul_pd(weights0, _mm256_mask_i32gather_pd(zero, x, indices0, all, 8)));
+        sum1 = _mm256_add_pd(sum1, _mm256_mul_pd(weights1, _mm256_mask_i32gather_pd(zero, x, indices1, all, 8)));
+    }
+    if (arc + 4 <= last)
+    {
+        __m128i indices = _mm_loadu_si128(reinterpret_cast<const __m128i *>(targets + arc));
+        __m256d rowWeights = _mm256_cvtepi32_pd(_mm_loadu_si128(reinterpret_cast<const __m128i *>(weights + arc)));
+        sum0 = _mm256_add_pd(sum0, _mm256_mul_pd(rowWeights, _mm256_mask_i32gather_pd(zero, x, indices, all, 8)));
+        arc += 4;
+    }
+
+    // Horizontal sum of both accumulators
+    __m256d sum = _mm256_add_pd(sum0, sum1);
+    __m128d half = _mm_add_pd(_mm256_castpd256_pd128(sum), _mm256_extractf128_pd(sum, 1));
+    double total = _mm_cvtsd_f64(_mm_add_sd(half, _mm_unpackhi_pd(half, half)));
+    return total + scalarRowProduct(targets, weights, arc, last, x);
+}
+
+#endif
+
+/**
+ * @brief Returns the first row of a thread's block, balancing rows plus arcs over the threads
+ * @param offsets The arc offsets of the graph
+ * @param rows The number of rows
+ * @param threadID The thread
+ * @param threads The number of threads
+ */
+inline int balancedRowBlock(const int64_t *offsets, int rows, int threadID, int threads)
+{
+    int64_t work = (offsets[rows] + rows) * threadID / threads;
+    int low = 0, high = rows;
+    while (low < high)
+    {
+        int middle = low + (high - low) / 2;
+        if (offsets[middle] + middle < work)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+    return low;
+}
+
+/**
+ * @brief Computes y = scale * (A x + diagonal * x) for the weighted adjacency matrix A of a graph
+ *
+ * The diagonal term turns the product into one with a shifted matrix, which power iteration needs
+ * to reach the other end of the spectrum, and the scale lets the caller fold a normalization in.
+ *
+ * @param graph The graph
+ * @param x The input vector with one entry per vertex
+ * @param y The output vector with one entry per vertex, must not overlap x
+ * @param diagonal The value added to every diagonal entry of A
+ * @param scale The factor applied to the result
+ * @return The squared Euclidean norm of y
+ */
+inline double sparseMatrixVectorProduct(const CSRGraph &graph, const double *x, double *y, double diagonal = 0, double scale = 1)
+{
+    int rows = graph.numberOfVertices();
+    const int64_t *offsets = graph.offsets();
+    const int *targets = graph.targets();
+    const int *weights = graph.weights();
+    int threads = static_cast<int>(std::min<int64_t>(numberOfThreads(), std::max<int64_t>(1, (graph.numberOfArcs() + rows) >> 15)));
+    std::vector<double> squaredNorms(threads, 0);
+
+#ifdef AE_X86_SIMD
+    bool useAVX2 = hasAVX2();
+#endif
+
+    parallelRun(threads, [&](int threadID)
+                {
+                    int first = balancedRowBlock(offsets, rows, threadID, threads);
+                    int last = balancedRowBlock(offsets, rows, threadID + 1, threads);
+                    double squaredNorm = 0;
+                    for (int row = first; row < last; ++row)
+                    {
+#ifdef AE_X86_SIMD
+                        double product = useAVX2 ? avx2RowProduct(targets, weights, offsets[row], offsets[row + 1], x)
+                                                 : scalarRowProduct(targets, weights, offsets[row], offsets[row + 1], x);
+#else
+                        double product = scalarRowProduct(targets, weights, offsets[row], offsets[row + 1], x);
+#endif
+                        y[row] = scale * (product + diagonal * x[row]);
+                        squaredNorm += y[row] * y[row];
+                    }
+                    squaredNorms[threadID] = squaredNorm;
+                });
+
+    double squaredNorm = 0;
+    for (double threadNorm : squaredNorms)
+        squaredNorm += threadNorm;
+    return squaredNorm;
+}
+
+#endif
@@ -4,25 +4,20 @@
 #include <iostream>
 #include <algorithm>
 #include <climits>
-#include <fstream>
 
-using namespace std;
+#include "graph_reader.h"
 
-// Define the structure for an edge in the graph
-struct Edge
-{
-    int source, destination, weight;
-};
+using namespace std;
 
-int main()
+int main(int argc, char *argv[])
 {
     // Improve the performance of cin
     ios_base::sync_with_stdio(false);
     cin.tie(NULL);
 
-    string path = "/Users/jan/Documents/code/AlgorithmEngineering/";
-    ifstream file(path + "example6.txt");
-    if (!file.is_open())
+    // Read from the file given as first argument, or from standard input
+    GraphReader file(argc > 1 ? argv[1] : nullptr);
+    if (!file.isOpen())
     {
         cerr << "Failed to open the file." << endl;
         return 1;
@@ -32,14 +27,12 @@ int main()
     int numNodes, numEdges;
     file >> numNodes >> numEdges;
 
-    // Create a vector to store all edges
-    vector<Edge> edges(numEdges);
-    for (int i = 0; i < numEdges; i++)
+    // Read all edges, the reader converts them to 0-indexed vertices
+    vector<InputEdge> edges = file.readEdges(numNodes, numEdges);
+    if (!file)
     {
-        // Read the source, destination and weight of each edge
-        int source, destination, weight;
-        file >> source >> destination >> weight;
-        edges[i] = (Edge){source - 1, destination - 1, weight};
+        cerr << "Invalid graph input." << endl;
+        return 1;
     }
 
     // Initialize vectors for cycle nodes, distances and previous nodes
@@ -55,7 +48,7 @@ int main()
     for (int i = 0; i < numNodes; ++i)
     {
         lastNodeInCycle = -1;
-        for (const Edge &edge : edges)
+        for (const InputEdge &edge : edges)
         {
             // Relax the edges
             if (distances[edge.source] < INT_MAX)
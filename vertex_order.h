@@ -0,0 +1,167 @@
+#ifndef VERTEX_ORDER_H
+#define VERTEX_ORDER_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+
+#include "parallel.h"
+
+/**
+ * Vertex orders by degree, weighted degree or any integer key in O(n) time.
+ *
+ * The keys are shifted to start at 0 and sorted with a stable parallel LSD radix sort on 8-bit digits,
+ * skipping the digits above the largest key. If the key range is small, as it is for degrees, a single
+ * counting sort pass over the whole range replaces the radix passes. Every pass builds one histogram per
+ * thread over a contiguous block of the input, so the scatter stays stable.
+ *
+ * Ascending orders break ties by the smaller vertex ID. Descending orders are the exact reverse, so
+ * they break ties by the larger vertex ID like sorting pair<key, vertex> with greater<>.
+ */
+
+/**
+ * @brief One stable counting pass that distributes (key, vertex) pairs by a digit of the key
+ * @param keys The keys in the current order
+ * @param vertices The vertices in the current order
+ * @param sortedKeys Receives the keys in the new order
+ * @param sortedVertices Receives the vertices in the new order
+ * @param shift The position of the digit in the key
+ * @param buckets The number of different digit values, a power of two
+ */
+inline void countingSortPass(const std::vector<uint64_t> &keys, const std::vector<int> &vertices,
+                             std::vector<uint64_t> &sortedKeys, std::vector<int> &sortedVertices, int shift, uint64_t buckets)
+{
+    int64_t n = static_cast<int64_t>(keys.size());
+    uint64_t mask = buckets - 1;
+    int threads = static_cast<int>(std::min<int64_t>(numberOfThreads(), std::max<int64_t>(1, n >> 16)));
+    std::vector<std::vector<int64_t> > counts(threads);
+
+    parallelRun(threads, [&](int threadID)
+                {
+                    std::vector<int64_t> &count = counts[threadID];
+                    count.assign(buckets, 0);
+                    for (int64_t i = n * threadID / threads; i < n * (threadID + 1) / threads; ++i)
+                        ++count[(keys[i] >> shift) & mask];
+                });
+
+    // Bucket by bucket, thread by thread, which keeps equal digits in their input order
+    int64_t position = 0;
+    for (uint64_t bucket = 0; bucket < buckets; ++bucket)
+        for (int threadID = 0; threadID < threads; ++threadID)
+        {
+            int64_t count = counts[threadID][bucket];
+            counts[threadID][bucket] = position;
+            position += count;
+        }
+
+    parallelRun(threads, [&](int threadID)
+                {
+                    std::vector<int64_t> &next = counts[threadID];
+                    for (int64_t i = n * threadID / threads; i < n * (threadID + 1) / threads; ++i)
+                    {
+                        int64_t target = next[(keys[i] >> shift) & mask]++;
+                        sortedKeys[target] = keys[i];
+                        sortedVertices[target] = vertices[i];
+                    }
+                });
+}
+
+/**
+ * @brief Returns the vertices sorted by an integer key
+ * @param keys The key of every vertex
+ * @param descending Whether the largest key comes first
+ * @return The vertex order
+ */
+inline std::vector<int> orderByKey(const std::vector<int64_t> &keys, bool descending = false)
+{
+    int n = static_cast<int>(keys.size());
+    std::vector<int> vertices(n);
+    if (n == 0)
+        return vertices;
+
+    int64_t minKey = *std::min_element(keys.begin(), keys.end());
+    std::vector<uint64_t> shiftedKeys(n);
+    std::vector<uint64_t> ranges(numberOfThreads(), 0);
+    parallelFor(0, n, [&](int threadID, int64_t first, int64_t last)
+                {
+                    for (int64_t vertex = first; vertex < last; ++vertex)
+                    {
+                        vertices[vertex] = static_cast<int>(vertex);
+                        shiftedKeys[vertex] = static_cast<uint64_t>(keys[vertex]) - static_cast<uint64_t>(minKey);
+                        ranges[threadID] = std::max(ranges[threadID], shiftedKeys[vertex]);
+                    }
+                });
+    uint64_t range = *std::max_element(ranges.begin(), ranges.end());
+
+    int bits = 0;
+    while (bits < 64 && (range >> bits) != 0)
+        ++bits;
+
+    std::vector<uint64_t> sortedKeys(n);
+    std::vector<int> sortedVertices(n);
+    if (bits <= 16)
+    {
+        // Counting sort over the whole key range
+        countingSortPass(shiftedKeys, vertices, sortedKeys, sortedVertices, 0, uint64_t(1) << bits);
+        shiftedKeys.swap(sortedKeys);
+        vertices.swap(sortedVertices);
+    }
+    else
+    {
+        for (int shift = 0; shift < bits; shift += 8)
+        {
+            countingSortPass(shiftedKeys, vertices, sortedKeys, sortedVertices, shift, 256);
+            shiftedKeys.swap(sortedKeys);
+            vertices.swap(sortedVertices);
+        }
+    }
+
+    if (descending)
+        std::reverse(vertices.begin(), vertices.end());
+    return vertices;
+}
+
+/**
+ * @brief Returns the vertices sorted by degree
+ * @param graph The graph, any type with numberOfVertices() and degree(vertex)
+ * @param descending Whether the largest degree comes first
+ * @return The vertex order
+ */
+template <typename WeightedGraph>
+std::vector<int> orderByDegree(const WeightedGraph &graph, bool descending = false)
+{
+    std::vector<int64_t> keys(graph.numberOfVertices());
+    parallelFor(0, graph.numberOfVertices(), [&](int, int64_t first, int64_t last)
+                {
+                    for (int64_t vertex = first; vertex < last; ++vertex)
+                        keys[vertex] = graph.degree(static_cast<int>(vertex));
+                });
+    return orderByKey(keys, descending);
+}
+
+/**
+ * @brief Returns the vertices sorted by the sum of the absolute weights of their arcs, which is the
+ * weighted degree for non-negative weights
+ * @param graph The graph, any type with the arc interface of CSRGraph
+ * @param descending Whether the largest weighted degree comes first
+ * @return The vertex order
+ */
+template <typename WeightedGraph>
+std::vector<int> orderByWeightedDegree(const WeightedGraph &graph, bool descending = false)
+{
+    std::vector<int64_t> keys(graph.numberOfVertices());
+    parallelFor(0, graph.numberOfVertices(), [&](int, int64_t first, int64_t last)
+                {
+                    for (int64_t vertex = first; vertex < last; ++vertex)
+                    {
+                        int64_t weight = 0;
+                        for (int64_t arc = graph.firstArc(static_cast<int>(vertex)); arc < graph.lastArc(static_cast<int>(vertex)); ++arc)
+                            weight += std::llabs(graph.weight(arc));
+                        keys[vertex] = weight;
+                    }
+                });
+    return orderByKey(keys, descending);
+}
+
+#endif